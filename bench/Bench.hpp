@@ -0,0 +1,76 @@
+/**
+ * Bench.hpp - Timing helpers shared by the benchmark programs
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define BENCH_MIN_TIME_MS 200       // each timed run repeats the operation for at least this long
+#define BENCH_RUNS 5                // timed runs per measurement, the fastest is reported
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bench {
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// keeps the compiler from dropping a computation whose result is never used
+template<typename T>
+inline void keep(const T &v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &v;
+#endif
+}
+
+/**
+ * @brief       Time an operation
+ * The operation is repeated until a run takes at least BENCH_MIN_TIME_MS, and the
+ * fastest of BENCH_RUNS runs is reported so other processes skew the result less.
+ * @param op    Operation, called with no arguments
+ * @return      Nanoseconds per call
+ */
+template<typename F>
+double ns_per_op(F op) {
+    // grow the batch until it is long enough to time
+    size_t batch = 1;
+    int64_t elapsed = 0;
+    while (elapsed < BENCH_MIN_TIME_MS * 1000000LL / 10) {
+        batch *= 2;
+        int64_t start = now_ns();
+        for (size_t i = 0; i < batch; i++) op();
+        elapsed = now_ns() - start;
+    }
+    batch *= 10;
+
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        int64_t start = now_ns();
+        for (size_t i = 0; i < batch; i++) op();
+        best = std::min(best, (double) (now_ns() - start) / (double) batch);
+    }
+    return best;
+}
+
+/**
+ * @brief           Value a share of the samples are at or below
+ * @param sorted    Samples in ascending order
+ * @param p         Share, 0 to 1
+ * @return          Sample at that rank, 0 if there are none
+ */
+inline double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    auto rank = (size_t) (p * (double) (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+}
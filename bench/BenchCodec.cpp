@@ -0,0 +1,84 @@
+/**
+ * BenchCodec.cpp - Bandwidth and CPU per message of the delta/LZ payload codec
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "../include/CDeltaCodec.hpp"
+#include "Bench.hpp"
+
+#define BENCH_COMMANDS 100000       // command strings per run
+#define BENCH_IMAGES 2000           // image frames per run
+#define BENCH_IMAGE_W 256           // image frame width, one byte per pixel
+#define BENCH_IMAGE_H 128           // image frame height
+
+// six-field command like TestUDPClient's, with two fields that keep changing
+std::vector<uint8_t> make_command(int n) {
+    std::string s = "A" + std::to_string(n % 200 - 100) + " B1 C" + std::to_string(n / 7 % 50) + " D1 E0 F1";
+    return {s.begin(), s.end()};
+}
+
+// a gradient with sensor noise and a block that moves a little every frame
+std::vector<uint8_t> make_image(int n, std::mt19937 &rng) {
+    std::vector<uint8_t> img(BENCH_IMAGE_W * BENCH_IMAGE_H);
+    int bx = (n * 3) % (BENCH_IMAGE_W - 32), by = (n * 2) % (BENCH_IMAGE_H - 32);
+    for (int y = 0; y < BENCH_IMAGE_H; y++) {
+        for (int x = 0; x < BENCH_IMAGE_W; x++) {
+            bool block = x >= bx && x < bx + 32 && y >= by && y < by + 32;
+            img[y * BENCH_IMAGE_W + x] = (uint8_t) (block ? 255 : (x + y) / 2);
+        }
+    }
+    for (int i = 0; i < 64; i++) img[rng() % img.size()] ^= 1;
+    return img;
+}
+
+// push a stream through an encoder and a decoder wired back to back, acks included
+template<typename Gen>
+void run(const char *name, uint8_t caps, int count, Gen gen) {
+    CDeltaCodec *enc_ptr = nullptr;
+    CDeltaCodec enc([](const std::vector<uint8_t> &) { return true; }, caps);
+    CDeltaCodec dec([&](const std::vector<uint8_t> &ack) {
+        enc_ptr->on_ack(ack.data(), ack.size());
+        return true;
+    }, caps);
+    enc_ptr = &enc;
+
+    std::vector<uint8_t> frame, out;
+    int64_t enc_ns = 0, dec_ns = 0;
+    uint64_t raw = 0, wire = 0;
+    int bad = 0;
+    for (int i = 0; i < count; i++) {
+        std::vector<uint8_t> payload = gen(i);
+        int64_t start = bench::now_ns();
+        enc.encode(payload.data(), payload.size(), frame);
+        int64_t mid = bench::now_ns();
+        dec.decode(frame.data(), frame.size(), out);
+        int64_t end = bench::now_ns();
+        enc_ns += mid - start;
+        dec_ns += end - mid;
+        raw += payload.size();
+        wire += frame.size();
+        if (out != payload) bad++;
+    }
+    std::printf("%-20s %10.1f %10.1f %8.1f%% %12.0f %12.0f%s\n", name, (double) raw / count, (double) wire / count,
+                100.0 * (double) wire / (double) raw, (double) enc_ns / count, (double) dec_ns / count,
+                bad ? "  MISMATCH" : "");
+}
+
+int main() {
+    std::printf("%-20s %10s %10s %9s %12s %12s\n", "stream", "raw B", "wire B", "wire", "encode ns", "decode ns");
+
+    run("command, keyframes", NET_CAP_LZ, BENCH_COMMANDS, make_command);
+    run("command, delta", NET_CAP_DELTA | NET_CAP_LZ, BENCH_COMMANDS, make_command);
+
+    std::mt19937 rng(1);
+    auto image = [&](int n) { return make_image(n, rng); };
+    run("image, keyframes", NET_CAP_LZ, BENCH_IMAGES, image);
+    rng.seed(1);
+    run("image, delta + lz", NET_CAP_DELTA | NET_CAP_LZ, BENCH_IMAGES, image);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * BenchCrc32c.cpp - CRC32C throughput of the runtime-selected and the portable implementation
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <cstdio>
+#include <random>
+
+#include "../include/CCrc32c.hpp"
+#include "Bench.hpp"
+
+int main() {
+    // a command, one MTU-sized datagram, a mid-size message and a 60 KB frame
+    const size_t sizes[] = {64, 1400, 8192, 60000};
+
+    std::vector<uint8_t> data(60000);
+    std::mt19937 rng(1);
+    for (auto &b : data) b = (uint8_t) rng();
+
+    std::printf("runtime implementation: %s\n", CCrc32c::get_impl());
+    std::printf("%8s %12s %10s %14s %12s %10s\n", "bytes", "ns", "GB/s", "frames/s/core", "portable ns", "GB/s");
+    int failed = 0;
+    for (size_t len : sizes) {
+        if (CCrc32c::compute(data.data(), len) != CCrc32c::compute_portable(data.data(), len)) failed++;
+
+        uint32_t crc = 0;
+        double fast = bench::ns_per_op([&] {
+            crc = CCrc32c::compute(data.data(), len, crc);
+            bench::keep(crc);
+        });
+        double portable = bench::ns_per_op([&] {
+            crc = CCrc32c::compute_portable(data.data(), len, crc);
+            bench::keep(crc);
+        });
+        std::printf("%8zu %12.1f %10.2f %14.0f %12.1f %10.2f\n", len, fast, (double) len / fast, 1e9 / fast,
+                    portable, (double) len / portable);
+    }
+    if (failed) std::printf("MISMATCH between implementations at %d sizes\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * BenchGso.cpp - Per-datagram send and receive cost of chunked messages on loopback, with and without GSO/GRO
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <pthread.h>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+#include "Bench.hpp"
+
+#define BENCH_PORT 52203            // first of two server ports, without and with GRO
+#define BENCH_CHUNK 1400            // payload bytes per datagram
+#define BENCH_WAIT 100              // a message not complete after this long (ms) counts as lost
+
+struct rx_side {
+    CUDPServer server;
+    std::thread thread;
+    std::atomic<uint64_t> completed{0};
+};
+
+void do_listen_server(rx_side *rx) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) {
+        if (rx->server.do_rx(rx_buf, src, rx_bytes)) rx->completed.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// CPU time a thread has used, sleeping in recvfrom doesn't count
+int64_t thread_cpu_ns(std::thread &t) {
+    clockid_t clock;
+    timespec ts{};
+    if (pthread_getcpuclockid(t.native_handle(), &clock) || clock_gettime(clock, &ts)) return 0;
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// send messages one at a time, each waits for the one before it so no socket buffer overflows
+void run(CUDPClient &c, bool gso, rx_side &rx, bool gro, int messages, size_t message_bytes) {
+    std::vector<uint8_t> message(message_bytes, 'x');
+    size_t per_message = (message_bytes + BENCH_CHUNK - 1) / BENCH_CHUNK;
+    int64_t tx_ns = 0;
+    int lost = 0;
+
+    int64_t rx_cpu = thread_cpu_ns(rx.thread);
+    int64_t start = bench::now_ns();
+    for (int i = 0; i < messages; i++) {
+        uint64_t before = rx.completed.load(std::memory_order_acquire);
+        int64_t tx_start = bench::now_ns();
+        c.do_tx_chunks(message, BENCH_CHUNK);
+        tx_ns += bench::now_ns() - tx_start;
+
+        int64_t deadline = bench::now_ns() + BENCH_WAIT * 1000000LL;
+        while (rx.completed.load(std::memory_order_acquire) == before && bench::now_ns() < deadline) {
+            std::this_thread::yield();
+        }
+        if (rx.completed.load(std::memory_order_acquire) == before) lost++;
+    }
+    double elapsed_s = (double) (bench::now_ns() - start) / 1e9;
+    rx_cpu = thread_cpu_ns(rx.thread) - rx_cpu;
+
+    double datagrams = (double) (per_message * messages);
+    std::printf("%-5s %-5s %12.2f %12.2f %10.0f %8d\n", gso ? "on" : "off", gro ? "on" : "off",
+                (double) tx_ns / datagrams / 1000.0, (double) rx_cpu / datagrams / 1000.0,
+                (double) message_bytes * (messages - lost) / elapsed_s / 1e6, lost);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: bench-gso [messages] [message KB]" << std::endl;
+        return 1;
+    }
+    int messages = argc > 1 ? std::stoi(argv[1]) : 5000;
+    size_t message_bytes = (argc > 2 ? std::stoul(argv[2]) : 64) * 1024;
+    spdlog::set_level(spdlog::level::warn);
+
+    rx_side plain, gro;
+    plain.server.setup(std::to_string(BENCH_PORT));
+    gro.server.setup(std::to_string(BENCH_PORT + 1));
+    bool gro_ok = gro.server.enable_gro();
+    plain.thread = std::thread(do_listen_server, &plain);
+    gro.thread = std::thread(do_listen_server, &gro);
+
+    // one client per server and GSO setting
+    CUDPClient c[4];
+    bool gso_ok = true;
+    for (int i = 0; i < 4; i++) {
+        c[i].setup("127.0.0.1", std::to_string(BENCH_PORT + i / 2));
+        if (i % 2) gso_ok &= c[i].enable_gso();
+    }
+
+    std::printf("%d messages of %zu KB in %d byte chunks over loopback\n", messages, message_bytes / 1024, BENCH_CHUNK);
+    if (!gso_ok) std::printf("GSO not supported here, \"on\" rows fell back to one send per datagram\n");
+    if (!gro_ok) std::printf("GRO not supported here, \"on\" rows fell back to one read per datagram\n");
+    std::printf("%-5s %-5s %12s %12s %10s %8s\n", "gso", "gro", "tx us/dgram", "rx us/dgram", "MB/s", "lost");
+    run(c[0], false, plain, false, messages, message_bytes);
+    run(c[1], true, plain, false, messages, message_bytes);
+    run(c[2], false, gro, true, messages, message_bytes);
+    run(c[3], true, gro, true, messages, message_bytes);
+    std::cout.flush();
+
+    // rx threads are still blocked in their sockets
+    std::_Exit(0);
+}
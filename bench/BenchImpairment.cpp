@@ -0,0 +1,173 @@
+/**
+ * BenchImpairment.cpp - Echo throughput and tail latency through CUDPProxy under seeded link profiles
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+#include "../include/CUDPProxy.hpp"
+#include "Bench.hpp"
+
+#define BENCH_SERVER_PORT "52205"
+#define BENCH_PROXY_PORT "52206"
+#define BENCH_DRAIN 1000            // wait for stragglers after the last send of a profile (ms)
+#define BENCH_HEADER 16             // run id (u32) + sequence (u32) + send time (i64) at the start of each message
+
+struct profile {
+    const char *name;
+    impairment_config link;         ///< Applied to both directions, the return path gets seed + 1
+};
+
+std::mutex lock;
+std::vector<double> rtt_ms;
+std::vector<bool> seen;
+uint64_t duplicates = 0;
+std::atomic<uint32_t> current_run{0};
+
+void do_echo_server(CUDPServer *s) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) {
+        if (s->do_rx(rx_buf, src, rx_bytes)) s->do_tx(rx_buf, src);
+    }
+}
+
+void do_listen_client(CUDPClient *c) {
+    std::vector<uint8_t> rx_buf;
+    long rx_bytes;
+    while (true) {
+        if (!c->do_rx(rx_buf, rx_bytes) || rx_buf.size() < BENCH_HEADER) continue;
+        uint32_t run, seq;
+        int64_t sent;
+        std::memcpy(&run, rx_buf.data(), 4);
+        std::memcpy(&seq, rx_buf.data() + 4, 4);
+        std::memcpy(&sent, rx_buf.data() + 8, 8);
+        std::lock_guard<std::mutex> guard(lock);
+
+        // late replies from the profile before don't count
+        if (run != current_run.load() || seq >= seen.size()) continue;
+        if (seen[seq]) {
+            duplicates++;
+            continue;
+        }
+        seen[seq] = true;
+        rtt_ms.push_back((double) (bench::now_ns() - sent) / 1e6);
+    }
+}
+
+void run(CUDPProxy &p, CUDPClient &c, const profile &prof, uint32_t id, double seconds, int rate, size_t bytes) {
+    impairment_config down = prof.link;
+    down.seed = prof.link.seed + 1;
+    p.configure(prof.link, down);
+
+    auto count = (uint32_t) (seconds * rate);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        rtt_ms.clear();
+        seen.assign(count, false);
+        duplicates = 0;
+        current_run = id;
+    }
+
+    std::vector<uint8_t> tx_buf(std::max(bytes, (size_t) BENCH_HEADER), 'x');
+    std::memcpy(tx_buf.data(), &id, 4);
+    auto next = std::chrono::steady_clock::now();
+    auto interval = std::chrono::nanoseconds((int64_t) (1e9 / rate));
+    int64_t start = bench::now_ns();
+    for (uint32_t seq = 0; seq < count; seq++) {
+        int64_t now = bench::now_ns();
+        std::memcpy(tx_buf.data() + 4, &seq, 4);
+        std::memcpy(tx_buf.data() + 8, &now, 8);
+        c.do_tx(tx_buf);
+        c.service();
+        next += interval;
+        std::this_thread::sleep_until(next);
+    }
+    // keep the heartbeats going, a silent client would be dropped by the server
+    auto drained = std::chrono::steady_clock::now() + std::chrono::milliseconds(BENCH_DRAIN);
+    while (std::chrono::steady_clock::now() < drained) {
+        c.service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double elapsed_s = (double) (bench::now_ns() - start) / 1e9 - BENCH_DRAIN / 1000.0;
+
+    std::vector<double> sorted;
+    uint64_t dups;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        sorted = rtt_ms;
+        dups = duplicates;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::printf("%-10s %8u %8zu %7.2f%% %6llu %9.2f %8.2f %8.2f %8.2f %8.2f\n", prof.name, count, sorted.size(),
+                100.0 * (1.0 - (double) sorted.size() / count), (unsigned long long) dups,
+                (double) sorted.size() * (double) tx_buf.size() * 8 / elapsed_s / 1e6,
+                bench::percentile(sorted, 0.5), bench::percentile(sorted, 0.99), bench::percentile(sorted, 0.999),
+                sorted.empty() ? 0.0 : sorted.back());
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 4) {
+        std::cerr << "Usage: bench-impairment [seconds per profile] [messages/s] [message bytes]" << std::endl;
+        return 1;
+    }
+    double seconds = argc > 1 ? std::stod(argv[1]) : 3;
+    int rate = argc > 2 ? std::stoi(argv[2]) : 1000;
+    size_t bytes = argc > 3 ? std::stoul(argv[3]) : 1200;
+    spdlog::set_level(spdlog::level::warn);
+
+    // one-way settings, the same on both legs
+    std::vector<profile> profiles(5);
+    profiles[0].name = "clean";
+    profiles[1].name = "lan";
+    profiles[1].link.delay_us = 500;
+    profiles[1].link.jitter_us = 200;
+    profiles[2].name = "wifi";
+    profiles[2].link.delay_us = 3000;
+    profiles[2].link.jitter_us = 2000;
+    profiles[2].link.loss = 0.01;
+    profiles[2].link.reorder = 0.01;
+    profiles[2].link.duplicate = 0.001;
+    profiles[3].name = "lte";
+    profiles[3].link.delay_us = 25000;
+    profiles[3].link.jitter_us = 8000;
+    profiles[3].link.dist = impairment_config::DELAY_PARETO;
+    profiles[3].link.loss = 0.002;
+    profiles[3].link.burst_enter = 0.005;
+    profiles[3].link.burst_exit = 0.3;
+    profiles[4].name = "congested";
+    profiles[4].link.delay_us = 5000;
+    profiles[4].link.rate_bps = 8000000;
+    profiles[4].link.queue_bytes = 64 * 1024;
+
+    CUDPServer s;
+    s.setup(BENCH_SERVER_PORT);
+    std::thread(do_echo_server, &s).detach();
+
+    CUDPProxy p;
+    if (!p.start(BENCH_PROXY_PORT, "127.0.0.1", BENCH_SERVER_PORT)) return 1;
+
+    CUDPClient c;
+    c.setup("127.0.0.1", BENCH_PROXY_PORT);
+    std::thread(do_listen_client, &c).detach();
+
+    std::printf("%d messages/s of %zu bytes for %.0f s per profile, echoed by the server\n", rate, bytes, seconds);
+    std::printf("%-10s %8s %8s %8s %6s %9s %8s %8s %8s %8s\n", "profile", "sent", "replies", "loss", "dups",
+                "Mbit/s", "p50 ms", "p99 ms", "p99.9 ms", "max ms");
+    for (size_t i = 0; i < profiles.size(); i++) {
+        run(p, c, profiles[i], (uint32_t) i + 1, seconds, rate, bytes);
+    }
+    std::cout.flush();
+
+    // rx threads are still blocked in their sockets
+    std::_Exit(0);
+}
@@ -0,0 +1,130 @@
+/**
+ * BenchPacing.cpp - Loss and delay of bursty frames through a bottleneck, with and without pacing
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+#include "../include/CUDPProxy.hpp"
+#include "Bench.hpp"
+
+#define BENCH_SERVER_PORT "52201"
+#define BENCH_PROXY_PORT "52202"
+#define BENCH_DATAGRAM 1400         // payload bytes per do_tx
+#define BENCH_FRAMES 60             // frames per run
+#define BENCH_FRAME_INTERVAL 33     // time between the starts of two frames (ms)
+#define BENCH_DRAIN 500             // wait for the bottleneck to empty after the last frame (ms)
+
+std::mutex lock;
+std::vector<double> delays_ms;
+sockaddr_in last_src{};
+
+void do_listen_server(CUDPServer *s) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) {
+        if (!s->do_rx(rx_buf, src, rx_bytes) || rx_buf.size() < sizeof(int64_t)) continue;
+        int64_t sent;
+        std::memcpy(&sent, rx_buf.data(), sizeof(sent));
+        std::lock_guard<std::mutex> guard(lock);
+        delays_ms.push_back((double) (bench::now_ns() - sent) / 1e6);
+        last_src = src;
+    }
+}
+
+// send BENCH_FRAMES frames through the proxy and report what reached the server
+void run(CUDPServer &s, CUDPProxy &p, CUDPClient &c, const char *name, size_t frame_bytes) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        delays_ms.clear();
+    }
+    uint64_t queue_dropped = p.get_up_stats().queue_dropped;
+
+    std::vector<uint8_t> tx_buf(BENCH_DATAGRAM, 'x');
+    size_t per_frame = (frame_bytes + BENCH_DATAGRAM - 1) / BENCH_DATAGRAM;
+    auto next = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        for (size_t i = 0; i < per_frame; i++) {
+            int64_t now = bench::now_ns();
+            std::memcpy(tx_buf.data(), &now, sizeof(now));
+            c.do_tx(tx_buf);
+        }
+        c.service();
+        next += std::chrono::milliseconds(BENCH_FRAME_INTERVAL);
+        std::this_thread::sleep_until(next);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_DRAIN));
+
+    std::vector<double> sorted;
+    sockaddr_in peer{};
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        sorted = delays_ms;
+        peer = last_src;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // interarrival jitter as the server's own stats see it
+    std::vector<sockaddr_in> peers;
+    std::vector<peer_stats> stats;
+    s.get_peer_stats(peers, stats);
+    double jitter = 0;
+    for (size_t i = 0; i < peers.size(); i++) {
+        if (peers[i].sin_port == peer.sin_port) jitter = stats[i].jitter_ms;
+    }
+
+    double sent = (double) (per_frame * BENCH_FRAMES);
+    std::printf("%-10s %9.0f %9zu %7.2f%% %10llu %8.2f %8.2f %8.2f %10.2f\n", name, sent, sorted.size(),
+                100.0 * (1.0 - (double) sorted.size() / sent),
+                (unsigned long long) (p.get_up_stats().queue_dropped - queue_dropped),
+                bench::percentile(sorted, 0.5), bench::percentile(sorted, 0.99),
+                sorted.empty() ? 0.0 : sorted.back(), jitter);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: bench-pacing [bottleneck Mbit/s] [frame KB]" << std::endl;
+        return 1;
+    }
+    double rate_mbit = argc > 1 ? std::stod(argv[1]) : 100;
+    size_t frame_bytes = (argc > 2 ? std::stoul(argv[2]) : 256) * 1024;
+    spdlog::set_level(spdlog::level::warn);
+
+    // the proxy is the switch: a fixed rate and a shallow tail-drop queue
+    impairment_config up;
+    up.rate_bps = (uint64_t) (rate_mbit * 1e6);
+    up.queue_bytes = 64 * 1024;
+
+    CUDPServer s;
+    s.setup(BENCH_SERVER_PORT);
+    std::thread(do_listen_server, &s).detach();
+
+    CUDPProxy p(up);
+    if (!p.start(BENCH_PROXY_PORT, "127.0.0.1", BENCH_SERVER_PORT)) return 1;
+
+    // a fresh client per run, so each run has its own peer stats at the server
+    CUDPClient bursty, paced;
+    bursty.setup("127.0.0.1", BENCH_PROXY_PORT);
+    paced.setup("127.0.0.1", BENCH_PROXY_PORT);
+    auto pace_rate = (uint64_t) (rate_mbit * 1e6 / 8 * 0.9);
+    paced.set_pacing(pace_rate, 4 * BENCH_DATAGRAM);
+
+    std::printf("%zu KB frames every %d ms through a %.0f Mbit/s bottleneck with a 64 KB queue\n",
+                frame_bytes / 1024, BENCH_FRAME_INTERVAL, rate_mbit);
+    std::printf("%-10s %9s %9s %8s %10s %8s %8s %8s %10s\n", "mode", "sent", "received", "loss", "q-drops",
+                "p50 ms", "p99 ms", "max ms", "jitter ms");
+    run(s, p, bursty, "burst", frame_bytes);
+    run(s, p, paced, "paced", frame_bytes);
+    std::cout.flush();
+
+    // rx thread is still blocked in its socket
+    std::_Exit(0);
+}
@@ -0,0 +1,97 @@
+/**
+ * BenchSchema.cpp - CMessageSchema encode/decode against formatting and parsing ASCII commands
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "../include/CMessageSchema.hpp"
+#include "Bench.hpp"
+
+// the six-field command TestUDPClient sends as "A1 B1 C1 D1 E1 F1"
+struct axes_cmd {
+    int16_t a;
+    int16_t b;
+    int16_t c;
+    int16_t d;
+    int16_t e;
+    int16_t f;
+};
+
+using axes_msg = CMessageSchema<0x20, axes_cmd,
+        NET_FIELD(axes_cmd, a), NET_FIELD(axes_cmd, b), NET_FIELD(axes_cmd, c),
+        NET_FIELD(axes_cmd, d), NET_FIELD(axes_cmd, e), NET_FIELD(axes_cmd, f)>;
+
+// changes every call so nothing can be computed once and reused
+axes_cmd next_cmd(int16_t &n) {
+    n++;
+    return {n, (int16_t) -n, (int16_t) (n * 3), 1, (int16_t) (n >> 2), 1000};
+}
+
+// what apps do without the schema: build a string, split it with stoi
+std::string format_cpp(const axes_cmd &cmd) {
+    return "A" + std::to_string(cmd.a) + " B" + std::to_string(cmd.b) + " C" + std::to_string(cmd.c) +
+           " D" + std::to_string(cmd.d) + " E" + std::to_string(cmd.e) + " F" + std::to_string(cmd.f);
+}
+
+bool parse_cpp(const std::string &s, axes_cmd &cmd) {
+    int16_t *fields[] = {&cmd.a, &cmd.b, &cmd.c, &cmd.d, &cmd.e, &cmd.f};
+    size_t pos = 0;
+    for (int16_t *field : fields) {
+        if (pos + 1 >= s.size()) return false;
+        size_t used;
+        *field = (int16_t) std::stoi(s.substr(pos + 1), &used);
+        pos += used + 2;
+    }
+    return true;
+}
+
+int main() {
+    int16_t n = 0;
+    axes_cmd cmd = next_cmd(n), out{};
+    char text[64];
+
+    double schema_enc = bench::ns_per_op([&] {
+        axes_msg::buffer buf = axes_msg::encode(next_cmd(n));
+        bench::keep(buf);
+    });
+    axes_msg::buffer encoded = axes_msg::encode(cmd);
+    double schema_dec = bench::ns_per_op([&] {
+        encoded[1] = (uint8_t) n++;
+        axes_msg::decode(encoded.data(), encoded.size(), out);
+        bench::keep(out);
+    });
+
+    double printf_enc = bench::ns_per_op([&] {
+        axes_cmd c = next_cmd(n);
+        std::snprintf(text, sizeof(text), "A%d B%d C%d D%d E%d F%d", c.a, c.b, c.c, c.d, c.e, c.f);
+        bench::keep(text);
+    });
+    std::snprintf(text, sizeof(text), "A%d B%d C%d D%d E%d F%d", cmd.a, cmd.b, cmd.c, cmd.d, cmd.e, cmd.f);
+    size_t printf_size = std::string(text).size();
+    double printf_dec = bench::ns_per_op([&] {
+        text[1] = (char) ('1' + (n++ & 7));
+        std::sscanf(text, "A%hd B%hd C%hd D%hd E%hd F%hd", &out.a, &out.b, &out.c, &out.d, &out.e, &out.f);
+        bench::keep(out);
+    });
+
+    double cpp_enc = bench::ns_per_op([&] {
+        std::string s = format_cpp(next_cmd(n));
+        bench::keep(s);
+    });
+    std::string formatted = format_cpp(cmd);
+    double cpp_dec = bench::ns_per_op([&] {
+        formatted[1] = (char) ('1' + (n++ & 7));
+        parse_cpp(formatted, out);
+        bench::keep(out);
+    });
+
+    std::printf("six int16 fields, encode and decode of one command\n");
+    std::printf("%-22s %8s %12s %12s\n", "codec", "bytes", "encode ns", "decode ns");
+    std::printf("%-22s %8zu %12.1f %12.1f\n", "CMessageSchema", axes_msg::size, schema_enc, schema_dec);
+    std::printf("%-22s %8zu %12.1f %12.1f\n", "snprintf / sscanf", printf_size, printf_enc, printf_dec);
+    std::printf("%-22s %8zu %12.1f %12.1f\n", "to_string / stoi", formatted.size(), cpp_enc, cpp_dec);
+    return 0;
+}
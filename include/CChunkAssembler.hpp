@@ -0,0 +1,87 @@
+/**
+ * CChunkAssembler.hpp - Reassembly of messages split by do_tx_chunks header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define CH_TYPE_CHUNK 0x17          // ETB, one piece of a message split into datagrams
+#define CH_HEADER_SIZE 7            // type + 16-bit message id + 16-bit index + 16-bit count
+#define CH_MAX_CHUNKS 65535         // most pieces one message can be split into
+#define CH_MAX_PARTIAL 8            // messages reassembled at once, the oldest is dropped past this
+#define CH_MAX_BYTES (16 << 20)     // bytes held by unfinished messages at once
+#define CH_TIMEOUT 2000             // unfinished message is dropped after this long without a new piece (ms)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Puts messages split into datagrams back together.
+ *
+ * Every piece carries the message id, its index and the piece count, so pieces may
+ * arrive in any order and interleaved with other traffic. A message is handed out once
+ * all its pieces are in. Pieces of a message that never completes are dropped when it
+ * goes stale, or when too many messages or bytes are waiting. Frame layout (integers
+ * little-endian):
+ *
+ *   CHUNK: 0x17 | message id (u16) | index (u16) | count (u16) | data
+ *
+ * Not locked, meant to be fed from the rx thread only.
+ */
+class CChunkAssembler {
+private:
+    struct partial {
+        uint64_t peer = 0;                                  ///< Sender key
+        uint16_t id = 0;                                    ///< Message id
+        uint16_t count = 0;                                 ///< Pieces in the message
+        uint16_t received = 0;                              ///< Pieces in so far
+        size_t bytes = 0;                                   ///< Data bytes in so far
+        int64_t last_ms = 0;                                ///< Arrival of the latest piece
+        std::vector<std::vector<uint8_t>> pieces;           ///< Data by index, empty if not in yet
+        std::vector<bool> have;                             ///< Piece at index is in
+    };
+
+    std::vector<partial> _partials;                         ///< Unfinished messages, at most CH_MAX_PARTIAL
+    size_t _bytes = 0;                                      ///< Data bytes held in _partials
+    std::vector<uint8_t> _done;                             ///< Message completed by the last piece
+    bool _ready = false;                                    ///< _done holds a message
+    uint64_t _completed = 0;                                ///< Messages handed out
+    uint64_t _dropped = 0;                                  ///< Messages given up on
+
+    /**
+     * @brief       Drop an unfinished message
+     * @param idx   Index into _partials
+     */
+    void drop(size_t idx);
+
+public:
+    /**
+     * @brief       Build the header of one piece
+     * @param out   Receives CH_HEADER_SIZE bytes
+     * @param id    Message id
+     * @param index Index of piece
+     * @param count Pieces in the message
+     */
+    static void make_header(uint8_t *out, uint16_t id, uint16_t index, uint16_t count);
+
+    /**
+     * @brief           Take in a received piece
+     * @param peer      Sender key, pieces of different senders are never mixed
+     * @param data      Pointer to frame, starting at the type byte
+     * @param len       Length of frame
+     * @param now_ms    Current time (ms, any monotonic clock)
+     */
+    void on_rx(uint64_t peer, const uint8_t *data, size_t len, int64_t now_ms);
+
+    /**
+     * @brief       Take the message completed by the last piece, if it completed one
+     * @param out   Buffer to receive message into
+     * @return      True if a message was completed
+     */
+    bool pop(std::vector<uint8_t> &out);
+
+    uint64_t get_completed() const;
+    uint64_t get_dropped() const;
+};
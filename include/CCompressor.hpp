@@ -0,0 +1,58 @@
+/**
+ * CCompressor.hpp - LZ4-style block compressor header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define LZ_MIN_MATCH 4              // shortest match worth a sequence
+#define LZ_HASH_BITS 12             // match finder table has 2^LZ_HASH_BITS entries
+#define LZ_MAX_OFFSET 65535         // offsets are 16-bit
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Greedy LZ77 block compressor using the LZ4 sequence layout.
+ *
+ * Each sequence is a token (literal length << 4 | match length - 4), extra literal
+ * length bytes, the literals, a 16-bit little-endian offset and extra match length
+ * bytes. Lengths of 15 or more continue in following bytes of up to 255. The last
+ * sequence has literals only, so a block ends where its input ends.
+ *
+ * An optional dictionary is treated as data just before the block, so matches can
+ * reach back into it. With the previous message as dictionary this is a delta encoder.
+ */
+class CCompressor {
+public:
+    /**
+     * @brief           Compress a block
+     * @param src       Data to compress
+     * @param len       Length of data
+     * @param dict      Dictionary, may be null
+     * @param dict_len  Length of dictionary
+     * @param out       Replaced with compressed block
+     */
+    static void compress(const uint8_t *src, size_t len, const uint8_t *dict, size_t dict_len, std::vector<uint8_t> &out);
+
+    /**
+     * @brief           Decompress a block
+     * @param src       Compressed block
+     * @param len       Length of compressed block
+     * @param dict      Dictionary used to compress, may be null
+     * @param dict_len  Length of dictionary
+     * @param max_len   Largest decompressed size accepted
+     * @param out       Replaced with decompressed data
+     * @return          True if the block was well formed and fit in max_len bytes
+     */
+    static bool decompress(const uint8_t *src, size_t len, const uint8_t *dict, size_t dict_len, size_t max_len, std::vector<uint8_t> &out);
+
+    /**
+     * @brief       Largest compressed size for a block
+     * @param len   Length of data
+     * @return      Worst case compressed length
+     */
+    static size_t bound(size_t len);
+};
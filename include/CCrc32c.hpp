@@ -0,0 +1,48 @@
+/**
+ * CCrc32c.hpp - CRC32C (Castagnoli) checksum header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define CRC32C_POLY 0x82F63B78      // reflected Castagnoli polynomial
+#define CRC32C_LANE 4096            // bytes per lane when hardware CRC runs three streams at once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC32C with hardware acceleration picked at runtime.
+ *
+ * Uses the SSE4.2 crc32 instruction on x86-64 and the ARMv8 CRC extension on AArch64
+ * when the CPU has them. Both run three independent streams over large buffers to hide
+ * the instruction's latency and merge them with a GF(2) shift. Otherwise a portable
+ * slice-by-8 table implementation is used. All implementations give the same result.
+ */
+class CCrc32c {
+public:
+    /**
+     * @brief       Compute or continue a CRC32C
+     * @param data  Data to checksum
+     * @param len   Length of data
+     * @param crc   Result of the previous chunk, 0 to start
+     * @return      CRC32C of all data so far
+     */
+    static uint32_t compute(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+    /**
+     * @brief       Compute or continue a CRC32C with the slice-by-8 tables, whatever the CPU has
+     * @param data  Data to checksum
+     * @param len   Length of data
+     * @param crc   Result of the previous chunk, 0 to start
+     * @return      CRC32C of all data so far
+     */
+    static uint32_t compute_portable(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+    /**
+     * @brief   Name of the implementation in use, e.g. "sse4.2", "armv8" or "slice-by-8"
+     * @return  Implementation name
+     */
+    static const char *get_impl();
+};
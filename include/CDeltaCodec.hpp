@@ -0,0 +1,130 @@
+/**
+ * CDeltaCodec.hpp - Delta and compression payload codec header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define NET_CAP_DELTA 0x01          // send deltas against the last acknowledged payload
+#define NET_CAP_LZ 0x02             // compress large keyframes
+#define NET_CAP_CODEC (NET_CAP_DELTA | NET_CAP_LZ)
+#define DC_TYPE_KEY 0x14            // DC4, complete payload
+#define DC_TYPE_DELTA 0x15          // NAK, payload compressed against an earlier one
+#define DC_TYPE_ACK 0x16            // SYN, decoder has an id and can use it as a base
+#define DC_KEY_HEADER_SIZE 4        // type + flags + 16-bit id
+#define DC_DELTA_HEADER_SIZE 4      // type + 16-bit id + base distance
+#define DC_ACK_SIZE 3               // type + 16-bit id
+#define DC_FLAG_LZ 0x01             // keyframe body is compressed
+#define DC_HISTORY 32               // payloads remembered on each side, deltas only use bases this recent
+#define DC_KEYFRAME_INTERVAL 64     // force a keyframe after this many deltas
+#define DC_ACK_INTERVAL 16          // decoder acks keyframes and every this many ids
+#define DC_LZ_MIN 64                // keyframes shorter than this are sent as is
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "CCompressor.hpp"
+
+/**
+ * Optional payload codec for one session, for streams of similar messages.
+ *
+ * The encoder sends keyframes (the whole payload, LZ compressed if NET_CAP_LZ and large
+ * enough) and deltas (the payload compressed with an earlier payload as dictionary, see
+ * CCompressor). Deltas only reference payloads the decoder has acknowledged, so a lost
+ * datagram never makes later ones undecodable. A keyframe goes out every
+ * DC_KEYFRAME_INTERVAL frames and whenever no recent base has been acknowledged.
+ * Frame layout (all integers little-endian):
+ *
+ *   KEY:   0x14 | flags (u8) | id (u16) | payload
+ *   DELTA: 0x15 | id (u16) | id - base id (u8) | compressed payload
+ *   ACK:   0x16 | id (u16)
+ *
+ * Both sides of a session use the same capabilities, agreed on in the handshake.
+ */
+class CDeltaCodec {
+public:
+    typedef std::function<bool(const std::vector<uint8_t> &)> tx_callback;
+
+private:
+    struct history {
+        std::vector<uint8_t> payload[DC_HISTORY];           ///< Payload per id % DC_HISTORY
+        uint16_t id[DC_HISTORY] = {};                       ///< Id stored in each slot
+        bool valid[DC_HISTORY] = {};                        ///< Slot holds a payload
+
+        void store(uint16_t frame_id, const uint8_t *data, size_t len);
+        const std::vector<uint8_t> *find(uint16_t frame_id) const;
+        void clear();
+    };
+
+    std::mutex _lock;                                       ///< Guards all codec state
+    tx_callback _tx;                                        ///< Sends acks back to the encoder
+    uint8_t _caps = 0;                                      ///< Agreed capabilities, 0 passes payloads through
+
+    // encoder state
+    uint16_t _tx_next_id = 0;                               ///< Id of next frame, never reset so stale acks can't match
+    history _tx_history;                                    ///< Payloads sent recently
+    bool _has_base = false;                                 ///< An acknowledged payload is available
+    uint16_t _base_id = 0;                                  ///< Most recent acknowledged payload
+    uint32_t _since_key = 0;                                ///< Frames since last keyframe
+    std::vector<uint8_t> _scratch;                          ///< Compressor output
+
+    // decoder state
+    history _rx_history;                                    ///< Payloads decoded recently
+
+    // counters
+    uint64_t _raw_bytes = 0;                                ///< Payload bytes passed to encode
+    uint64_t _encoded_bytes = 0;                            ///< Frame bytes produced by encode
+
+public:
+    /**
+     * @brief       Constructor for CDeltaCodec
+     * @param tx    Callback used to send acks
+     * @param caps  Agreed capabilities (NET_CAP_*)
+     */
+    explicit CDeltaCodec(tx_callback tx, uint8_t caps = 0);
+
+    /**
+     * @brief       Change capabilities and forget all history, the next frame is a keyframe
+     * @param caps  Agreed capabilities (NET_CAP_*)
+     */
+    void reset(uint8_t caps);
+
+    /**
+     * @brief       Encode a payload
+     * @param data  Payload
+     * @param len   Length of payload
+     * @param frame Replaced with the frame to send
+     * @return      True if encoded, false if the codec is off and the payload should go out as is
+     */
+    bool encode(const uint8_t *data, size_t len, std::vector<uint8_t> &frame);
+
+    /**
+     * @brief       Decode a received KEY or DELTA frame, acking it if needed
+     * @param data  Pointer to frame, starting at the type byte
+     * @param len   Length of frame
+     * @param out   Replaced with the payload
+     * @return      True if decoded, false if malformed or its base is unknown
+     */
+    bool decode(const uint8_t *data, size_t len, std::vector<uint8_t> &out);
+
+    /**
+     * @brief       Process a received ACK frame
+     * @param data  Pointer to frame, starting at the type byte
+     * @param len   Length of frame
+     */
+    void on_ack(const uint8_t *data, size_t len);
+
+    /**
+     * @brief   Check if a frame type belongs to the codec
+     * @param   type First byte of frame
+     * @return  True if it is a codec frame
+     */
+    static bool is_codec_frame(uint8_t type);
+
+    uint8_t get_caps();
+    uint64_t get_raw_bytes();
+    uint64_t get_encoded_bytes();
+};
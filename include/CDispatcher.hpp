@@ -0,0 +1,88 @@
+/**
+ * CDispatcher.hpp - Message dispatch by type id header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#ifdef WIN32
+#include "Winsock2.h"
+#else
+#include <netinet/in.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include "CMessageSchema.hpp"
+#include "CNetLog.hpp"
+
+/**
+ * Routes received messages to handlers by their first byte (the type id).
+ *
+ * Handlers live in flat 256-entry tables, so dispatch is one index and one call, and
+ * they get a pointer into the receive buffer instead of a copy. Library frames are
+ * marked in the prefix (FRAME_CTRL_MARK) and have a table of their own, so app data
+ * that happens to start with a library type id is never mistaken for one. Messages
+ * with a registered handler never reach the application's rx queue. Register handlers
+ * before the rx thread starts; they run on the rx thread.
+ */
+class CDispatcher {
+public:
+    typedef std::function<void(const uint8_t *data, size_t len, const sockaddr_in &src)> handler;
+
+private:
+    handler _handlers[256];                                 ///< App handler per type id, empty if unhandled
+    handler _frames[256];                                   ///< Library frame handler per type id
+
+public:
+    /**
+     * @brief       Register a handler for a type id, replacing any existing one
+     * @param type  Type id (first byte of message)
+     * @param h     Handler, empty to unregister
+     */
+    void on(uint8_t type, handler h);
+
+    /**
+     * @brief       Register a handler for a library frame type, used by the endpoint classes
+     * @param type  Type id (first byte of a frame sent with FRAME_CTRL_MARK)
+     * @param h     Handler, empty to unregister
+     */
+    void on_frame(uint8_t type, handler h);
+
+    /**
+     * @brief       Register a handler for a CMessageSchema message, decoded on the stack
+     * @param h     Called with the decoded message
+     */
+    template<typename Schema>
+    void on_msg(std::function<void(const typename Schema::message_type &msg, const sockaddr_in &src)> h) {
+        on(Schema::type_id, [h](const uint8_t *data, size_t len, const sockaddr_in &src) {
+            typename Schema::message_type msg;
+            if (!Schema::decode(data, len, msg)) {
+                NET_LOG_LIMITED(spdlog::level::err, "Malformed typed message received");
+                return;
+            }
+            h(msg, src);
+        });
+    }
+
+    /**
+     * @brief           Pass a message to its handler
+     * @param data      Pointer to message, starting at the type id
+     * @param len       Length of message
+     * @param src       Sender of message
+     * @param control   True if the prefix marked it as a library frame
+     * @return          True if a handler took the message or it was a library frame, false if the app should get it
+     */
+    bool dispatch(const uint8_t *data, size_t len, const sockaddr_in &src, bool control) const {
+        if (!len) return false;
+        const handler &h = control ? _frames[data[0]] : _handlers[data[0]];
+        if (h) h(data, len, src);
+
+        // library frames nobody handles (e.g. reliable frames with the channel off) are dropped
+        return control || h;
+    }
+};
@@ -0,0 +1,71 @@
+/**
+ * CFrame.hpp - Timestamp prefix framing header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define FRAME_ENQ 0x05              // ping request
+#define FRAME_ACK 0x06              // ping response
+#define FRAME_EOT 0x04              // peer is going away
+#define FRAME_CTRL_MARK '!'         // prefix flag, the body is a library frame rather than app data
+#define FRAME_CRC_MARK '#'          // precedes the CRC32C in the prefix
+#define FRAME_CRC_DIGITS 8          // CRC32C is written as fixed-width hex
+#define NET_CAP_CRC 0x04            // handshake capability, CRC32C in every prefix
+#define FRAME_PREFIX_MAX 48         // longest "<time>:<seq>!#<crc> " prefix
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "CCrc32c.hpp"
+
+/**
+ * Parsed "<time>[:<seq>][!][#<crc>] <body>" prefix of a datagram.
+ * The '!' marks library frames (handshake, reliable, RPC, codec), whose first body byte
+ * is a type id. Without it the body is app data, whatever its first byte is.
+ * The CRC32C covers everything before the '#' and the body.
+ */
+struct frame_header {
+    int64_t time_ms = 0;            ///< Timestamp from prefix
+    uint32_t seq = 0;               ///< Sequence number, valid if has_seq
+    bool has_seq = false;           ///< Prefix carried a sequence number
+    bool control = false;           ///< Body is a library frame (FRAME_CTRL_MARK)
+    uint32_t crc = 0;               ///< CRC32C from prefix, valid if has_crc
+    bool has_crc = false;           ///< Prefix carried a CRC32C
+    size_t crc_start = 0;           ///< Offset of the CRC mark, end of the checksummed prefix
+    size_t time_len = 0;            ///< Length of the timestamp digits
+    size_t body_start = 0;          ///< Offset of the body
+};
+
+class CFrame {
+public:
+    /**
+     * @brief       Parse the prefix of a received datagram in place, without copying it
+     * @param data  Received bytes
+     * @param len   Number of received bytes
+     * @param hdr   Filled with parsed prefix
+     * @return      True if the prefix is well formed and a body follows, false otherwise
+     */
+    static bool parse(const uint8_t *data, size_t len, frame_header &hdr);
+
+    /**
+     * @brief       Check the CRC32C of a parsed datagram
+     * @param data  Received bytes
+     * @param len   Number of received bytes
+     * @param hdr   Parsed prefix
+     * @return      True if the CRC matches or there is none, false if the datagram is corrupt
+     */
+    static bool check_crc(const uint8_t *data, size_t len, const frame_header &hdr);
+
+    /**
+     * @brief           Append the CRC32C of a prefix and body to the prefix
+     * @param prefix    "<time>[:<seq>][!]", gets "#<crc>" appended
+     * @param head      Start of body when it is sent in two parts, may be null
+     * @param head_len  Length of head
+     * @param body      Body (or rest of it) that will follow the prefix
+     * @param len       Length of body
+     */
+    static void append_crc(std::string &prefix, const uint8_t *head, size_t head_len, const uint8_t *body, size_t len);
+};
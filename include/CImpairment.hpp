@@ -0,0 +1,104 @@
+/**
+ * CImpairment.hpp - Seeded network impairment model header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define IMP_PARETO_SHAPE 3.0        // tail index of the pareto delay distribution
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+/**
+ * How packets on one direction of a link are impaired.
+ */
+struct impairment_config {
+    enum distribution {
+        DELAY_UNIFORM,              ///< Base delay +- jitter, evenly spread
+        DELAY_NORMAL,               ///< Base delay + normal noise with jitter as standard deviation
+        DELAY_PARETO                ///< Base delay + heavy-tailed extra delay with jitter as its mean
+    };
+
+    int64_t delay_us = 0;           ///< Base one-way delay
+    int64_t jitter_us = 0;          ///< Delay variation, meaning depends on distribution
+    distribution dist = DELAY_NORMAL;
+    bool jitter_reorders = false;   ///< Let jitter reorder packets, otherwise only reorder does
+    double loss = 0;                ///< Loss probability (in the good state if bursts are on)
+    double burst_enter = 0;         ///< Gilbert-Elliott good to bad probability per packet, 0 turns bursts off
+    double burst_exit = 1;          ///< Gilbert-Elliott bad to good probability per packet
+    double burst_loss = 1;          ///< Loss probability in the bad state
+    double reorder = 0;             ///< Probability a packet is held back so later ones overtake it
+    int64_t reorder_us = 5000;      ///< Extra delay of a held back packet
+    double duplicate = 0;           ///< Probability a packet is delivered twice
+    uint64_t rate_bps = 0;          ///< Bottleneck rate in bits per second, 0 is unlimited
+    size_t queue_bytes = 256 * 1024; ///< Bottleneck queue, packets that don't fit are dropped
+    uint64_t seed = 1;              ///< Random seed, same seed and packets give the same decisions
+};
+
+/**
+ * Plain copy of an impairment model's counters.
+ */
+struct impairment_stats {
+    uint64_t packets = 0;           ///< Packets offered
+    uint64_t delivered = 0;         ///< Deliveries scheduled, duplicates included
+    uint64_t lost = 0;              ///< Dropped by random or burst loss
+    uint64_t burst_lost = 0;        ///< Of lost, dropped while in the bad state
+    uint64_t queue_dropped = 0;     ///< Dropped because the bottleneck queue was full
+    uint64_t reordered = 0;         ///< Held back to be overtaken
+    uint64_t duplicated = 0;        ///< Delivered twice
+};
+
+/**
+ * Decides what a simulated link does to each packet: lose it, queue it behind a
+ * bandwidth cap, delay it, hold it back or duplicate it.
+ *
+ * Packets first pass a bottleneck of rate_bps with a tail-drop queue, then get the
+ * propagation delay drawn from the configured distribution. Loss is either independent
+ * or follows a two-state Gilbert-Elliott chain for bursts. Every random draw comes from
+ * one generator seeded from the config, and time is passed in, so a run can be replayed
+ * exactly.
+ */
+class CImpairment {
+private:
+    /**
+     * @brief   Draw the propagation delay of one packet, lock must be held
+     * @return  Delay (us)
+     */
+    int64_t draw_delay();
+
+    std::mutex _lock;                                       ///< Guards everything below
+    impairment_config _config;                              ///< Current settings
+    std::mt19937_64 _rng;                                   ///< Source of every random decision
+    bool _bad = false;                                      ///< Gilbert-Elliott chain is in the bad state
+    int64_t _link_free_us = 0;                              ///< When the bottleneck finishes its queue
+    int64_t _last_delivery_us = 0;                          ///< Latest delivery so far, keeps order if jitter mustn't reorder
+    impairment_stats _stats;                                ///< Counters
+
+public:
+    /**
+     * @brief           Constructor for CImpairment
+     * @param config    Settings
+     */
+    explicit CImpairment(const impairment_config &config = impairment_config());
+
+    /**
+     * @brief           Change settings and start over from the config's seed
+     * @param config    Settings
+     */
+    void configure(const impairment_config &config);
+
+    /**
+     * @brief           Decide the fate of one packet
+     * @param len       Packet size in bytes
+     * @param now_us    Time the packet enters the link
+     * @param out       Filled with delivery times
+     * @return          Number of deliveries, 0 if dropped, 2 if duplicated
+     */
+    size_t schedule(size_t len, int64_t now_us, int64_t out[2]);
+
+    impairment_stats get_stats();
+};
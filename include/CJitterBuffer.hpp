@@ -0,0 +1,137 @@
+/**
+ * CJitterBuffer.hpp - Playout jitter buffer header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define JB_CAPACITY 64              // messages held at once, also the reorder window in sequence numbers
+#define JB_MIN_DELAY 2              // smallest margin over mean transit time (ms)
+#define JB_MAX_DELAY 200            // largest margin over mean transit time (ms)
+#define JB_JITTER_MULT 4            // margin is this many times the measured jitter
+#define JB_TRANSIT_GAIN 32          // mean transit follows each sample by 1/JB_TRANSIT_GAIN
+#define JB_MAX_DROPOUT 3000         // jump ahead larger than this is treated as a sender restart
+#define JB_MAX_MISORDER 100         // jump back larger than this is treated as a sender restart
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Plain copy of a jitter buffer's counters.
+ */
+struct jitter_stats {
+    uint64_t pushed = 0;            ///< Messages accepted into the buffer
+    uint64_t released = 0;          ///< Messages played out
+    uint64_t late = 0;              ///< Dropped for arriving after their playout time
+    uint64_t duplicated = 0;        ///< Dropped for being buffered already
+    uint64_t overflowed = 0;        ///< Dropped to make room when the window was full
+    uint64_t skipped = 0;           ///< Sequence numbers played past, lost or used by frames the app never sees
+    uint64_t restarts = 0;          ///< Times the sender's sequence jumped and the buffer started over
+    size_t depth = 0;               ///< Messages waiting now
+    double transit_ms = 0;          ///< Mean transit time (sender clock to local clock)
+    double jitter_ms = 0;           ///< Mean deviation from the transit time
+    double margin_ms = 0;           ///< Current playout margin over the mean transit time
+};
+
+/**
+ * Reorders timestamped messages and releases them on the sender's cadence.
+ *
+ * A message that left the sender at time t is played out at t + mean transit + margin,
+ * where the margin is JB_JITTER_MULT times the measured jitter, clamped to the configured
+ * range. The estimates adapt with every arrival, so the delay only grows as much as the
+ * link needs. Messages come out in sequence order; a gap is played past as soon as the
+ * message after it is due, and anything that arrives after its playout time or behind
+ * what was already played is dropped.
+ *
+ * Messages live in a fixed ring indexed by sequence number, so push is O(1), pop scans
+ * at most the gap ahead of it, and memory is bounded by the capacity. Slots keep their
+ * storage, so a steady stream doesn't allocate. Safe to push and pop from different threads.
+ */
+class CJitterBuffer {
+private:
+    struct slot {
+        std::vector<uint8_t> data;                          ///< Payload
+        uint32_t seq = 0;                                   ///< Sequence number
+        int64_t time_ms = 0;                                ///< Sender timestamp
+        bool valid = false;                                 ///< Slot holds a message
+    };
+
+    /**
+     * @brief   Start over from a sequence number, lock must be held
+     * @param   seq First sequence number expected
+     */
+    void restart(uint32_t seq);
+
+    /**
+     * @brief   Playout time of a sender timestamp under the current estimates, lock must be held
+     * @param   time_ms Sender timestamp
+     * @return  Local time to release at (ms)
+     */
+    int64_t due(int64_t time_ms) const;
+
+    /**
+     * @brief   First buffered message at or after the next sequence number, lock must be held
+     * @return  Its slot, null if empty
+     */
+    slot *front();
+
+    mutable std::mutex _lock;                               ///< Guards everything below
+    std::vector<slot> _slots;                               ///< Ring indexed by seq % capacity
+    int64_t _min_margin;                                    ///< Smallest playout margin (ms)
+    int64_t _max_margin;                                    ///< Largest playout margin (ms)
+    bool _started = false;                                  ///< A message has been seen
+    uint32_t _next = 0;                                     ///< Next sequence number to play out
+    size_t _count = 0;                                      ///< Valid slots
+    double _transit = 0;                                    ///< Mean transit time (ms)
+    double _jitter = 0;                                     ///< Mean deviation from _transit (ms)
+    jitter_stats _stats;                                    ///< Counters, depth and estimates filled in on read
+
+public:
+    /**
+     * @brief               Constructor for CJitterBuffer
+     * @param capacity      Messages held at once, rounded up to a power of two
+     * @param min_delay_ms  Smallest playout margin over the mean transit time
+     * @param max_delay_ms  Largest playout margin over the mean transit time
+     */
+    explicit CJitterBuffer(size_t capacity = JB_CAPACITY, int64_t min_delay_ms = JB_MIN_DELAY, int64_t max_delay_ms = JB_MAX_DELAY);
+
+    /**
+     * @brief           Add a received message
+     * @param seq       Sequence number
+     * @param time_ms   Sender timestamp
+     * @param data      Payload
+     * @param len       Length of payload
+     * @param now_ms    Local arrival time, same clock as pop()
+     * @return          True if buffered, false if dropped as late or duplicate
+     */
+    bool push(uint32_t seq, int64_t time_ms, const uint8_t *data, size_t len, int64_t now_ms);
+
+    /**
+     * @brief           Take the next message if its playout time has come
+     * @param out       Replaced with the payload
+     * @param now_ms    Local time
+     * @return          True if a message was released
+     */
+    bool pop(std::vector<uint8_t> &out, int64_t now_ms);
+
+    /**
+     * @brief           Time until the next message is due, for sleeping between pops
+     * @param now_ms    Local time
+     * @return          Milliseconds until due (0 if due now), -1 if empty
+     */
+    int64_t time_to_next(int64_t now_ms);
+
+    /**
+     * @brief   Drop everything buffered and forget the estimates
+     */
+    void reset();
+
+    /**
+     * @brief   Copy current counters (any thread)
+     * @return  Snapshot of counters
+     */
+    jitter_stats get_stats() const;
+};
@@ -0,0 +1,187 @@
+/**
+ * CMessageSchema.hpp - Compile-time message codec for fixed-layout structs
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define MSG_MAX_SIZE 65000          // largest encoded message, leaves room for the timestamp prefix
+#define MSG_TYPE_USER_MIN 0x20      // type ids below this are reserved for control and protocol frames
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Header-only codec for fixed-layout command structs.
+ *
+ * Describe a message once by listing its fields:
+ *
+ *   struct drive_cmd { int16_t left; int16_t right; float heading; };
+ *   using drive_msg = CMessageSchema<0x20, drive_cmd,
+ *           NET_FIELD(drive_cmd, left), NET_FIELD(drive_cmd, right), NET_FIELD(drive_cmd, heading)>;
+ *
+ * The encoded size is a compile-time constant. Encoding writes the type id followed by
+ * each field in little-endian order, into a std::array, so nothing is allocated and no
+ * virtual calls are involved. Supported field types are integers, enums, bool, float,
+ * double and std::array of those.
+ */
+namespace net_schema {
+
+// unsigned type with the same width as an integer, bool or enum field
+template<typename T, typename = void>
+struct raw_type {
+    using type = std::make_unsigned_t<T>;
+};
+
+template<>
+struct raw_type<bool> {
+    using type = uint8_t;
+};
+
+template<typename T>
+struct raw_type<T, std::enable_if_t<std::is_enum<T>::value>> {
+    using type = std::make_unsigned_t<std::underlying_type_t<T>>;
+};
+
+template<typename T, typename = void>
+struct codec {
+    static_assert(sizeof(T) == 0, "Unsupported message field type");
+};
+
+// integers, bool and enums, written byte by byte so host endianness doesn't matter
+template<typename T>
+struct codec<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>> {
+    static constexpr size_t size = sizeof(T);
+
+    using raw = typename raw_type<T>::type;
+
+    static void encode(const T &v, uint8_t *out) {
+        auto u = (raw) v;
+        for (size_t i = 0; i < size; i++) out[i] = (uint8_t) (u >> (8 * i));
+    }
+
+    static void decode(const uint8_t *in, T &v) {
+        raw u = 0;
+        for (size_t i = 0; i < size; i++) u |= (raw) ((raw) in[i] << (8 * i));
+        v = (T) u;
+    }
+};
+
+// floating point goes through its bit pattern
+template<typename T>
+struct codec<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only 32 and 64 bit floats are supported");
+    using bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    static constexpr size_t size = sizeof(T);
+
+    static void encode(const T &v, uint8_t *out) {
+        bits b;
+        std::memcpy(&b, &v, sizeof(b));
+        codec<bits>::encode(b, out);
+    }
+
+    static void decode(const uint8_t *in, T &v) {
+        bits b;
+        codec<bits>::decode(in, b);
+        std::memcpy(&v, &b, sizeof(v));
+    }
+};
+
+// fixed-size arrays, element by element
+template<typename T, size_t N>
+struct codec<std::array<T, N>> {
+    static constexpr size_t size = codec<T>::size * N;
+
+    static void encode(const std::array<T, N> &v, uint8_t *out) {
+        for (size_t i = 0; i < N; i++) codec<T>::encode(v[i], out + i * codec<T>::size);
+    }
+
+    static void decode(const uint8_t *in, std::array<T, N> &v) {
+        for (size_t i = 0; i < N; i++) codec<T>::decode(in + i * codec<T>::size, v[i]);
+    }
+};
+
+/**
+ * One member of a message struct.
+ */
+template<typename S, typename T, T S::*Member>
+struct field {
+    static constexpr size_t size = codec<T>::size;
+
+    static void encode(const S &s, uint8_t *out) {
+        codec<T>::encode(s.*Member, out);
+    }
+
+    static void decode(const uint8_t *in, S &s) {
+        codec<T>::decode(in, s.*Member);
+    }
+};
+
+}
+
+#define NET_FIELD(S, member) net_schema::field<S, decltype(S::member), &S::member>
+
+template<uint8_t TypeId, typename S, typename... Fields>
+class CMessageSchema {
+public:
+    typedef S message_type;
+
+    static constexpr uint8_t type_id = TypeId;
+    static constexpr size_t payload_size = (Fields::size + ... + 0);
+    static constexpr size_t size = 1 + payload_size;        ///< Encoded size including type id
+
+    static_assert(sizeof...(Fields) > 0, "Message needs at least one field");
+    static_assert(TypeId >= MSG_TYPE_USER_MIN, "Type ids below MSG_TYPE_USER_MIN are reserved");
+    static_assert(size <= MSG_MAX_SIZE, "Message too large for one datagram");
+
+    typedef std::array<uint8_t, size> buffer;
+
+    /**
+     * @brief       Encode a message into a caller-provided buffer
+     * @param msg   Message to encode
+     * @param out   Buffer of at least size bytes
+     */
+    static void encode(const S &msg, uint8_t *out) {
+        out[0] = TypeId;
+        size_t offset = 1;
+        ((Fields::encode(msg, out + offset), offset += Fields::size), ...);
+    }
+
+    /**
+     * @brief       Encode a message
+     * @param msg   Message to encode
+     * @return      Encoded bytes
+     */
+    static buffer encode(const S &msg) {
+        buffer out;
+        encode(msg, out.data());
+        return out;
+    }
+
+    /**
+     * @brief       Decode a message
+     * @param in    Received bytes, starting at the type id
+     * @param len   Number of received bytes
+     * @param msg   Filled with decoded fields
+     * @return      True if the bytes hold this message type, false otherwise
+     */
+    static bool decode(const uint8_t *in, size_t len, S &msg) {
+        if (len != size || in[0] != TypeId) return false;
+        size_t offset = 1;
+        ((Fields::decode(in + offset, msg), offset += Fields::size), ...);
+        return true;
+    }
+
+    /**
+     * @brief       Check if received bytes hold this message type
+     * @param in    Received bytes, starting at the type id
+     * @param len   Number of received bytes
+     * @return      True if type id and size match
+     */
+    static bool matches(const uint8_t *in, size_t len) {
+        return len == size && in[0] == TypeId;
+    }
+};
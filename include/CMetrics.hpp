@@ -0,0 +1,182 @@
+/**
+ * CMetrics.hpp - Runtime metrics registry header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define METRICS_MAX 256             // max live metrics, fixed so readers never see a reallocation
+#define METRICS_SHARDS 16           // counter shards, threads are spread across them
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Metric ids for the counters every endpoint exposes.
+ */
+struct net_metrics {
+    int rx_packets = -1;            ///< Datagrams/reads that returned data
+    int rx_bytes = -1;              ///< Bytes received
+    int tx_packets = -1;            ///< Datagrams/writes sent
+    int tx_bytes = -1;              ///< Bytes sent
+    int rx_eagain = -1;             ///< Nonblocking receive attempts that found nothing
+    int rx_malformed = -1;          ///< Received data that couldn't be parsed
+    int rx_bad_crc = -1;            ///< Received datagrams whose CRC32C didn't match
+    int tx_errors = -1;             ///< Failed sends
+    int queue_depth = -1;           ///< Gauge, pending items in the endpoint's internal queue
+    int in_flight = -1;             ///< Gauge, reliable frames awaiting acknowledgement
+};
+
+/**
+ * Lock-free metrics registry.
+ *
+ * Counters are split into cache-line sized shards and each thread increments its own
+ * shard with a relaxed atomic add, so the hot path never contends or locks. Readers
+ * sum the shards. Registration, removal and snapshots take a lock, but only the first
+ * two change the registry and they happen at setup and teardown. Removed slots are
+ * reused, so endpoints can come and go without filling the registry up.
+ */
+class CMetrics {
+public:
+    enum metric_type {
+        COUNTER,
+        GAUGE
+    };
+
+    struct sample {
+        std::string name;           ///< Metric name, Prometheus style
+        std::string help;           ///< One line description
+        std::string labels;         ///< Label set without braces, e.g. endpoint="udp_client"
+        metric_type type = COUNTER; ///< Counter or gauge
+        int64_t value = 0;          ///< Value at time of snapshot
+    };
+
+private:
+    struct alignas(64) shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    struct entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        metric_type type = COUNTER;
+        bool live = false;                                  ///< Registered, false once removed
+        shard shards[METRICS_SHARDS];                       ///< Counter shards
+        std::atomic<int64_t> gauge{0};                      ///< Gauge value
+    };
+
+    mutable std::mutex _register_lock;                      ///< Guards registration, removal and snapshots
+    std::unique_ptr<entry> _entries[METRICS_MAX];           ///< Registered metrics, allocated once per slot
+    std::atomic<int> _count{0};                             ///< Slots used so far, removed ones are reused first
+    std::atomic<int> _instances{0};                         ///< Endpoint instances registered
+
+    /**
+     * @brief   Shard used by the calling thread
+     * @return  Shard index
+     */
+    static size_t thread_shard();
+
+    int add(const std::string &name, const std::string &help, const std::string &labels, metric_type type);
+
+    /**
+     * @brief       Drop a metric from snapshots and free its slot (lock must be held)
+     * @param id    Metric id, ignored if negative
+     */
+    void remove(int id);
+
+public:
+    /**
+     * @brief   Process-wide registry used by the endpoint classes
+     * @return  Registry
+     */
+    static CMetrics &global();
+
+    /**
+     * @brief           Register a counter
+     * @param name      Metric name
+     * @param help      One line description
+     * @param labels    Label set without braces
+     * @return          Metric id, -1 if the registry is full
+     */
+    int add_counter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    /**
+     * @brief           Register a gauge
+     * @param name      Metric name
+     * @param help      One line description
+     * @param labels    Label set without braces
+     * @return          Metric id, -1 if the registry is full
+     */
+    int add_gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    /**
+     * @brief           Register the standard endpoint metrics under a new instance label
+     * @param endpoint  Endpoint kind, e.g. udp_client
+     * @return          Ids of registered metrics
+     */
+    net_metrics add_endpoint(const std::string &endpoint);
+
+    /**
+     * @brief           Remove an endpoint's metrics, called when the endpoint goes away
+     * The ids are set to -1, so later inc()/set() calls with them do nothing.
+     * @param metrics   Ids returned by add_endpoint()
+     */
+    void remove_endpoint(net_metrics &metrics);
+
+    /**
+     * @brief       Add to a counter
+     * @param id    Metric id, ignored if negative
+     * @param n     Amount to add
+     */
+    void inc(int id, uint64_t n = 1) {
+        if (id < 0) return;
+        _entries[id]->shards[thread_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief       Set a gauge
+     * @param id    Metric id, ignored if negative
+     * @param v     New value
+     */
+    void set(int id, int64_t v) {
+        if (id < 0) return;
+        _entries[id]->gauge.store(v, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Copy all metrics, safe to call from any thread
+     * @return  Current values
+     */
+    std::vector<sample> snapshot() const;
+
+    std::string to_prometheus() const;
+    std::string to_json() const;
+
+    /**
+     * @brief       Write metrics to a file, atomically replacing it
+     * @param path  File to write
+     * @param json  JSON if true, Prometheus text otherwise
+     * @return      True if written, false otherwise
+     */
+    bool export_file(const std::string &path, bool json = false) const;
+
+    /**
+     * @brief       Send metrics to a local (unix domain) stream socket
+     * @param path  Socket path the node agent listens on
+     * @param json  JSON if true, Prometheus text otherwise
+     * @return      True if sent, false otherwise
+     */
+    bool export_socket(const std::string &path, bool json = false) const;
+};
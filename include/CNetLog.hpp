@@ -0,0 +1,130 @@
+/**
+ * CNetLog.hpp - Hot path logging helpers header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define NET_LOG_INTERVAL_MS 1000    // min time between messages from one call site
+#define NET_LOG_QUEUE_SIZE 8192     // async logger queue length
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+/**
+ * Lets one message through per interval and counts the rest.
+ *
+ * Every limiter is registered with CNetLog, so counts that no later message got to
+ * report can still be flushed, see CNetLog::flush_suppressed().
+ */
+class CLogLimiter {
+private:
+    std::atomic<int64_t> _next_ms{0};                       ///< Earliest time the next message may go out
+    std::atomic<uint64_t> _suppressed{0};                   ///< Messages dropped since the last one logged
+    int64_t _interval_ms;                                   ///< Min time between messages
+    std::mutex _last_lock;                                  ///< Guards the two below, only taken when a message goes out
+    spdlog::level::level_enum _last_level = spdlog::level::info; ///< Level of the last message logged
+    std::string _last;                                      ///< Last message logged, repeated when flushing
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    explicit CLogLimiter(int64_t interval_ms = NET_LOG_INTERVAL_MS);
+    ~CLogLimiter();
+
+    /**
+     * @brief               Check if a message may be logged now
+     * @param suppressed    Set to the number of messages dropped since the last one
+     * @return              True if the message should be logged
+     */
+    bool allow(uint64_t &suppressed) {
+        int64_t now = now_ms();
+        int64_t next = _next_ms.load(std::memory_order_relaxed);
+        if (now < next || !_next_ms.compare_exchange_strong(next, now + _interval_ms, std::memory_order_relaxed)) {
+            _suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief               Log a message that allow() let through, and remember it for flush()
+     * @param level         Level to log at
+     * @param msg           Message
+     * @param suppressed    Count from allow(), added to the message if nonzero
+     */
+    void log(spdlog::level::level_enum level, const std::string &msg, uint64_t suppressed);
+
+    /**
+     * @brief       Report messages suppressed since the last one, if no later message will
+     * @param force True to report even if the interval isn't over yet, e.g. at shutdown
+     */
+    void flush(bool force);
+};
+
+/**
+ * Logger setup for programs using the library.
+ */
+class CNetLog {
+public:
+    /**
+     * @brief               Replace the default spdlog logger with an async one
+     * Formatting and I/O move to a background thread, so a log call on the packet
+     * path only costs a queue push. When the queue is full, the oldest message is dropped.
+     * Later calls keep the logger set up by the first one.
+     * @param queue_size    Messages the queue can hold
+     */
+    static void init_async(size_t queue_size = NET_LOG_QUEUE_SIZE);
+
+    /**
+     * @brief       Report counts of suppressed messages that no later message has reported
+     * Cheap unless a NET_LOG_INTERVAL_MS has passed since the last flush. The endpoints'
+     * service() calls it, so counts come out at most one interval late.
+     * @param force True to report everything now and skip the interval check
+     */
+    static void flush_suppressed(bool force = false);
+
+    /**
+     * @brief Flush all suppressed counts and the async queue, call before exiting
+     */
+    static void shutdown();
+
+    /**
+     * @brief           Add or remove a limiter from the list flush_suppressed() walks
+     * @param limiter   Limiter
+     * @param add       True to add, false to remove
+     */
+    static void register_limiter(CLogLimiter *limiter, bool add);
+};
+
+/**
+ * Log at most once per NET_LOG_INTERVAL_MS from this call site. The next message
+ * that gets through reports how many were suppressed in between.
+ */
+#define NET_LOG_LIMITED(level, msg) \
+    do { \
+        static CLogLimiter _net_log_limiter; \
+        uint64_t _net_log_suppressed = 0; \
+        if (_net_log_limiter.allow(_net_log_suppressed)) { \
+            _net_log_limiter.log(level, msg, _net_log_suppressed); \
+        } \
+    } while (0)
+
+// debug/info on the packet path, compiled out entirely with VIKANET_STRIP_HOT_LOGS
+#ifdef VIKANET_STRIP_HOT_LOGS
+#define NET_HOT_DEBUG(msg) ((void) 0)
+#define NET_HOT_INFO(msg) ((void) 0)
+#else
+#define NET_HOT_DEBUG(msg) NET_LOG_LIMITED(spdlog::level::debug, msg)
+#define NET_HOT_INFO(msg) NET_LOG_LIMITED(spdlog::level::info, msg)
+#endif
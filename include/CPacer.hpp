@@ -0,0 +1,65 @@
+/**
+ * CPacer.hpp - Token bucket send pacer header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * Token bucket used to spread datagrams over time.
+ *
+ * Tokens are bytes. They refill at the configured rate up to the burst size. A send
+ * that needs more tokens than are available puts the bucket into debt and is told
+ * when it may go out, so oversized datagrams are delayed instead of rejected.
+ */
+class CPacer {
+private:
+    std::mutex _lock;                                       ///< Guards bucket state
+    double _rate = 0;                                       ///< Refill rate in bytes per second, 0 disables pacing
+    double _burst = 0;                                      ///< Bucket capacity in bytes
+    double _tokens = 0;                                     ///< Bytes currently available, negative when in debt
+    std::chrono::steady_clock::time_point _last;            ///< Time of last refill
+
+    /**
+     * @brief       Add tokens for the time elapsed since last refill (lock must be held)
+     * @param now   Current time
+     */
+    void refill(std::chrono::steady_clock::time_point now);
+
+public:
+    /**
+     * @brief       Constructor for CPacer
+     * @param rate  Bytes per second, 0 disables pacing
+     * @param burst Max bytes that may go out back to back
+     */
+    explicit CPacer(uint64_t rate = 0, uint64_t burst = 0);
+
+    /**
+     * @brief       Change rate and burst size, bucket starts full
+     * @param rate  Bytes per second, 0 disables pacing
+     * @param burst Max bytes that may go out back to back
+     */
+    void set_rate(uint64_t rate, uint64_t burst);
+
+    /**
+     * @brief       Take tokens for a datagram
+     * @param bytes Size of datagram
+     * @return      Time at which the datagram may be sent
+     */
+    std::chrono::steady_clock::time_point reserve(size_t bytes);
+
+    /**
+     * @brief       Take tokens for a datagram and sleep until it may be sent
+     * @param bytes Size of datagram
+     */
+    void wait(size_t bytes);
+
+    bool is_enabled();
+    uint64_t get_rate();
+};
@@ -0,0 +1,141 @@
+/**
+ * CPeerStats.hpp - Per-peer loss, reorder and jitter statistics header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define STATS_WINDOW 64             // sequence numbers tracked behind the highest seen
+#define STATS_MAX_DROPOUT 3000      // jump ahead larger than this is treated as a peer restart
+#define STATS_MAX_MISORDER 100      // jump back larger than this is treated as a peer restart
+#define STATS_MAX_PEERS 64          // peer slots in a CPeerStatsTable
+#define STATS_KEY_FREED UINT64_MAX  // slot key of a released slot, probing carries on past it
+#define STATS_KEY_CLAIMING (UINT64_MAX - 1) // slot key while a new peer's slot is being cleared
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Plain copy of a peer's counters, safe to pass around.
+ */
+struct peer_stats {
+    uint64_t received = 0;          ///< Unique packets received
+    uint64_t lost = 0;              ///< Packets expected but never received
+    uint64_t reordered = 0;         ///< Packets that arrived after a higher sequence number
+    uint64_t duplicated = 0;        ///< Packets received more than once
+    uint32_t highest_seq = 0;       ///< Highest sequence number seen
+    double jitter_ms = 0;           ///< Interarrival jitter estimate (RFC 3550)
+};
+
+/**
+ * Tracks sequence numbers from one peer.
+ *
+ * on_rx() must only be called from a single thread (the rx thread). Counters are
+ * published through relaxed atomics so snapshot() can be called from any thread
+ * without locking the rx path.
+ */
+class CPeerStats {
+private:
+    // rx thread only
+    bool _started = false;                                  ///< True once first packet is seen
+    uint32_t _base_seq = 0;                                 ///< First sequence number since last restart
+    uint32_t _max_seq = 0;                                  ///< Highest sequence number seen
+    uint64_t _window = 0;                                   ///< Bit i set if _max_seq - i was received
+    uint64_t _received_since_base = 0;                      ///< Unique packets since last restart
+    uint64_t _lost_carry = 0;                               ///< Losses counted before last restart
+    int64_t _last_transit_ms = 0;                           ///< Transit time of previous packet
+    double _jitter = 0;                                     ///< Running jitter estimate
+
+    // published counters
+    std::atomic<uint64_t> _received{0};
+    std::atomic<uint64_t> _lost{0};
+    std::atomic<uint64_t> _reordered{0};
+    std::atomic<uint64_t> _duplicated{0};
+    std::atomic<uint32_t> _highest_seq{0};
+    std::atomic<double> _jitter_ms{0};
+
+    /**
+     * @brief       Start tracking again from a sequence number
+     * @param seq   Sequence number to restart from
+     */
+    void restart(uint32_t seq);
+
+public:
+    /**
+     * @brief Forget everything, for a slot handed to a new peer
+     */
+    void reset();
+
+    /**
+     * @brief               Record a received packet (rx thread only)
+     * @param seq           Sequence number of packet
+     * @param sent_ms       Sender timestamp of packet
+     * @param arrival_ms    Local arrival time of packet
+     */
+    void on_rx(uint32_t seq, int64_t sent_ms, int64_t arrival_ms);
+
+    /**
+     * @brief   Copy current counters (any thread)
+     * @return  Snapshot of counters
+     */
+    peer_stats snapshot() const;
+};
+
+/**
+ * Fixed set of CPeerStats slots keyed by peer address, for servers.
+ *
+ * Slots are claimed with a CAS on the key, so lookups and reads never lock. Released
+ * slots keep a STATS_KEY_FREED key so probing still finds peers stored past them,
+ * and are cleared when they are claimed again. A full table simply stops tracking
+ * new peers.
+ */
+class CPeerStatsTable {
+private:
+    struct slot {
+        std::atomic<uint64_t> key{0};                       ///< Peer key, 0 if never used, STATS_KEY_FREED if released
+        std::atomic<uint32_t> tx_seq{0};                    ///< Next sequence number to send to this peer
+        CPeerStats stats;                                   ///< Receive stats from this peer
+    };
+
+    slot _slots[STATS_MAX_PEERS];
+
+    /**
+     * @brief       Find or claim the slot for a peer
+     * @param key   Nonzero peer key (address and port)
+     * @param claim True to claim a free slot if the peer has none
+     * @return      Slot for peer, nullptr if not found or the table is full
+     */
+    slot *find(uint64_t key, bool claim);
+
+public:
+    /**
+     * @brief       Find or claim the slot for a peer
+     * @param key   Nonzero peer key (address and port)
+     * @return      Stats for peer, nullptr if the table is full
+     */
+    CPeerStats *get(uint64_t key);
+
+    /**
+     * @brief       Get next outgoing sequence number for a peer
+     * @param key   Nonzero peer key (address and port)
+     * @param seq   Set to the sequence number
+     * @return      True if the peer has a slot, false if the table is full
+     */
+    bool next_tx_seq(uint64_t key, uint32_t &seq);
+
+    /**
+     * @brief       Free a peer's slot once it is gone, e.g. when its session is dropped
+     * @param key   Nonzero peer key (address and port)
+     */
+    void release(uint64_t key);
+
+    /**
+     * @brief       Copy stats of every known peer
+     * @param keys  Filled with peer keys
+     * @param stats Filled with stats, same order as keys
+     */
+    void snapshot(std::vector<uint64_t> &keys, std::vector<peer_stats> &stats) const;
+};
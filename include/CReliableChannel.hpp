@@ -0,0 +1,167 @@
+/**
+ * CReliableChannel.hpp - Selective-ACK reliable delivery channel header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define RC_TYPE_DATA 0x10           // DLE, reliable data frame
+#define RC_TYPE_SACK 0x11           // DC1, selective acknowledgement frame
+#define RC_HEADER_SIZE 9            // type + 32-bit epoch + 32-bit sequence number
+#define RC_SACK_SIZE 18             // type + 32-bit epoch + 32-bit cumulative ack + 64-bit SACK bitmap + flags
+#define RC_SACK_RESET 0x01          // SACK flag, receiver doesn't know this epoch, sender must start a new one
+#define RC_WINDOW_DEFAULT 32        // default max frames in flight
+#define RC_WINDOW_MAX 64            // window can't outgrow the SACK bitmap
+#define RC_RTO_INITIAL 200          // initial retransmit timeout (ms)
+#define RC_RTO_MIN 20               // lower clamp for retransmit timeout (ms)
+#define RC_RTO_MAX 2000             // upper clamp for retransmit timeout (ms)
+#define RC_DUP_THRESHOLD 3          // SACKs past a hole before fast retransmit
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "CNetLog.hpp"
+
+/**
+ * Reliable, in-order delivery on top of an unreliable datagram transport.
+ *
+ * The channel does not own a socket. Frames are handed to the transmit callback
+ * and incoming frames are passed in through on_rx(), so it can share a socket with
+ * the regular unreliable traffic. Frame layout (all integers little-endian):
+ *
+ *   DATA: 0x10 | epoch (u32) | seq (u32) | payload
+ *   SACK: 0x11 | epoch (u32) | cumulative ack (u32, next expected seq) | bitmap (u64, bit i = cum + 1 + i received) | flags (u8)
+ *
+ * Each sender numbers its frames from 0 within a random epoch. A receiver that sees a
+ * new epoch starting at seq 0 follows it. One that joins an epoch part way through
+ * (its peer lost state, e.g. an expired session) answers with RC_SACK_RESET, and the
+ * sender renumbers whatever is still unacked from 0 in a new epoch.
+ */
+class CReliableChannel {
+public:
+    typedef std::function<bool(const std::vector<uint8_t> &)> tx_callback;
+
+private:
+    struct in_flight {
+        uint32_t seq = 0;                                   ///< Sequence number of frame
+        std::vector<uint8_t> frame;                         ///< Complete frame, ready for retransmit
+        std::chrono::steady_clock::time_point sent;         ///< Time of last transmission
+        int retransmits = 0;                                ///< Number of times frame was resent
+        int dup_sacks = 0;                                  ///< SACKs received that skipped this frame
+        bool sacked = false;                                ///< Receiver has selectively acked this frame
+    };
+
+    std::mutex _lock;                                       ///< Guards all channel state
+    tx_callback _tx;                                        ///< Sends a frame on the underlying transport
+    size_t _window = RC_WINDOW_DEFAULT;                     ///< Max frames in flight
+
+    // sender state
+    uint32_t _tx_epoch = 0;                                 ///< Epoch of our frames, nonzero
+    uint32_t _tx_next_seq = 0;                              ///< Next sequence number to assign
+    std::deque<in_flight> _in_flight;                       ///< Unacknowledged frames, ordered by seq
+    double _srtt_ms = 0;                                    ///< Smoothed round trip time
+    double _rttvar_ms = 0;                                  ///< Round trip time variance
+    int _rto_ms = RC_RTO_INITIAL;                           ///< Current retransmit timeout
+    bool _rtt_valid = false;                                ///< True once a RTT sample has been taken
+
+    // receiver state
+    uint32_t _rx_epoch = 0;                                 ///< Epoch of the peer's frames, 0 until the first one
+    uint32_t _rx_refused = 0;                               ///< Epoch joined part way through, dropped until the peer restarts
+    uint32_t _rx_next_seq = 0;                              ///< Next in-order sequence number expected
+    std::map<uint32_t, std::vector<uint8_t>> _rx_ooo;       ///< Out of order payloads waiting for holes
+    std::queue<std::vector<uint8_t>> _rx_ready;             ///< In-order payloads ready for the app
+
+    // counters
+    uint64_t _retransmit_count = 0;                         ///< Total frames resent
+
+    /**
+     * @brief Send a SACK describing current receiver state (lock must be held)
+     */
+    void send_sack();
+
+    /**
+     * @brief       Ask the peer to start a new epoch (lock must be held)
+     * @param epoch Epoch the peer is sending in
+     */
+    void send_reset(uint32_t epoch);
+
+    /**
+     * @brief Renumber unacked frames from 0 in a new epoch and resend them (lock must be held)
+     */
+    void restart_epoch();
+
+    /**
+     * @brief   Pick a random nonzero epoch
+     * @return  Epoch
+     */
+    static uint32_t new_epoch();
+
+    /**
+     * @brief       Process an incoming SACK (lock must be held)
+     * @param data  Pointer to SACK frame
+     */
+    void handle_sack(const uint8_t *data);
+
+    /**
+     * @brief           Take a RTT sample and update the retransmit timeout (RFC 6298)
+     * @param sample_ms Measured round trip time
+     */
+    void update_rtt(double sample_ms);
+
+public:
+    /**
+     * @brief           Constructor for CReliableChannel
+     * @param tx        Callback used to put frames on the wire
+     * @param window    Max frames in flight, clamped to RC_WINDOW_MAX
+     */
+    explicit CReliableChannel(tx_callback tx, size_t window = RC_WINDOW_DEFAULT);
+
+    /**
+     * @brief           Queue a payload for reliable delivery and send it
+     * @param payload   Data to send
+     * @return          True if sent, false if the window is full or tx failed
+     */
+    bool send(const std::vector<uint8_t> &payload);
+
+    /**
+     * @brief       Feed a received frame to the channel
+     * @param data  Pointer to frame, starting at the type byte
+     * @param len   Length of frame
+     * @return      True if the frame belonged to the reliable channel
+     */
+    bool on_rx(const uint8_t *data, size_t len);
+
+    /**
+     * @brief       Pop the next in-order payload
+     * @param out   Buffer to receive payload into
+     * @return      True if a payload was available, false otherwise
+     */
+    bool recv(std::vector<uint8_t> &out);
+
+    /**
+     * @brief Retransmit frames whose timer has expired
+     * Meant to be called periodically, e.g. from the send loop.
+     */
+    void service();
+
+    /**
+     * @brief   Check if a frame type belongs to the reliable channel
+     * @param   type First byte of frame
+     * @return  True if it is a reliable channel frame
+     */
+    static bool is_reliable_frame(uint8_t type);
+
+    size_t get_in_flight();
+    int get_rto_ms();
+    uint64_t get_retransmit_count();
+};
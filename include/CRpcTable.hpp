@@ -0,0 +1,108 @@
+/**
+ * CRpcTable.hpp - In-flight RPC call table header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define RPC_TYPE_CALL 0x12          // DC2, request frame
+#define RPC_TYPE_REPLY 0x13         // DC3, response frame
+#define RPC_HEADER_SIZE 5           // type + 32-bit request id
+#define RPC_MAX_IN_FLIGHT 1024      // max outstanding calls per client
+#define RPC_TIMEOUT 500             // default per-call timeout (ms)
+
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Outstanding calls keyed by request id.
+ *
+ * Open addressing with linear probing and backward-shift deletion, so the table
+ * never fills with tombstones under constant call churn. Capacity is fixed at twice
+ * RPC_MAX_IN_FLIGHT, which keeps probe chains short and never reallocates.
+ *
+ * Frame layout (integers little-endian):
+ *
+ *   CALL:  0x12 | id (u32) | payload
+ *   REPLY: 0x13 | id (u32) | payload
+ */
+class CRpcTable {
+private:
+    static constexpr size_t CAPACITY = RPC_MAX_IN_FLIGHT * 2;
+
+    struct entry {
+        bool used = false;                                  ///< Slot holds a call
+        uint32_t id = 0;                                    ///< Request id
+        uint64_t timer = 0;                                 ///< Timeout timer to cancel on reply
+        std::promise<std::vector<uint8_t>> result;          ///< Completed by reply or timeout
+    };
+
+    std::mutex _lock;                                       ///< Guards table
+    std::vector<entry> _entries;                            ///< Slots, CAPACITY long
+    size_t _count = 0;                                      ///< Calls in flight
+    uint32_t _next_id = 1;                                  ///< Next request id to hand out
+
+    static size_t home(uint32_t id);
+    long find(uint32_t id) const;
+    void erase(size_t idx);
+
+public:
+    CRpcTable();
+
+    /**
+     * @brief           Register a new call
+     * @param id        Set to the request id to put on the wire
+     * @param result    Set to the future the reply will complete
+     * @return          True if registered, false if too many calls are in flight
+     */
+    bool add(uint32_t &id, std::future<std::vector<uint8_t>> &result);
+
+    /**
+     * @brief       Remember the timeout timer of a call
+     * @param id    Request id
+     * @param timer Timer id to cancel when the reply arrives
+     */
+    void set_timer(uint32_t id, uint64_t timer);
+
+    /**
+     * @brief           Complete a call with its reply
+     * @param id        Request id
+     * @param payload   Reply payload
+     * @param timer     Set to the call's timeout timer, 0 if none
+     * @return          True if the call was in flight, false for late or unknown replies
+     */
+    bool complete(uint32_t id, std::vector<uint8_t> payload, uint64_t &timer);
+
+    /**
+     * @brief       Fail a call
+     * @param id    Request id
+     * @param error Exception to hand to the waiter
+     * @return      True if the call was in flight
+     */
+    bool fail(uint32_t id, std::exception_ptr error);
+
+    /**
+     * @brief           Build a call or reply frame
+     * @param type      RPC_TYPE_CALL or RPC_TYPE_REPLY
+     * @param id        Request id
+     * @param payload   Frame payload
+     * @return          Complete frame
+     */
+    static std::vector<uint8_t> make_frame(uint8_t type, uint32_t id, const std::vector<uint8_t> &payload);
+
+    /**
+     * @brief       Read the header of a call or reply frame
+     * @param data  Pointer to frame, starting at the type byte
+     * @param len   Length of frame
+     * @param type  Set to frame type
+     * @param id    Set to request id
+     * @return      True if this is a well-formed RPC frame
+     */
+    static bool parse_frame(const uint8_t *data, size_t len, uint8_t &type, uint32_t &id);
+
+    size_t get_in_flight();
+};
@@ -4,13 +4,9 @@
  * vika <https://github.com/hi-im-vika>
  */
 
-
-#pragma once
-
 #pragma once
 
 #define TCP_TIMEOUT 100
-#define UDP_MAX_SIZE 65535
 
 #include <thread>
 #include <iomanip>
@@ -23,6 +19,7 @@
 #include "Winsock2.h"
 #include <ws2tcpip.h>
 #else
+#include <poll.h>
 #include <sys/fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -32,29 +29,41 @@
 
 #include <spdlog/spdlog.h>
 
-class CTCPClient {
+#include "CEndpoint.hpp"
+#include "CMetrics.hpp"
+#include "CNetLog.hpp"
+#include "CZeroCopy.hpp"
+
+class CTCPClient : private tcp_endpoint {
 private:
     bool init_net();
+    bool tx_stream(const uint8_t *data, size_t len, CZeroCopy::held *zc);
 
-#ifdef WIN32
-    WSADATA _wsdat;                         ///< Winsock object
-#endif
     std::string _host;
     int _port = 0;
-    int _socket_fd = 0;
     bool _socket_ok = false;
     ssize_t _rx_code = 0;
     ssize_t _tx_code = 0;
     struct sockaddr_in _server_addr{};
     socklen_t _server_addr_len = 0;
+    net_metrics _metrics = CMetrics::global().add_endpoint("tcp_client");
+    CZeroCopy _zerocopy;
 
 public:
     CTCPClient();
     ~CTCPClient();
     void setup(const std::string& host, const std::string& port);
-    void setdn() const;
+    void setdn();
     bool do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes);
     bool do_tx(const std::vector<uint8_t> &tx_buf);
 
+    // send all of tx_buf, without a copy if zero-copy is on and it is large enough. the buffer
+    // comes back through zerocopy().set_release_callback() once the kernel is done with it
+    bool do_tx_zerocopy(std::vector<uint8_t> &&tx_buf);
+
+    // send with MSG_ZEROCOPY from sends of threshold bytes up, call after every setup()
+    bool enable_zerocopy(bool enable = true, size_t threshold = ZC_THRESHOLD);
+    CZeroCopy &zerocopy();
+
     bool get_socket_status();
 };
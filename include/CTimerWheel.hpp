@@ -0,0 +1,96 @@
+/**
+ * CTimerWheel.hpp - Hierarchical timer wheel header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define TW_LEVELS 4                 // wheel levels, each level covers TW_SLOTS times the previous
+#define TW_SLOT_BITS 6
+#define TW_SLOTS (1 << TW_SLOT_BITS)
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * Hierarchical hashed timer wheel.
+ *
+ * Timers are kept in per-slot intrusive lists, so schedule() and cancel() are O(1)
+ * regardless of how many timers are pending. Level 0 holds timers due within
+ * TW_SLOTS ticks; timers further out sit in coarser levels and cascade down as the
+ * wheel turns. The wheel does not read the clock itself, it is driven by advance()
+ * from the owner's event loop.
+ */
+class CTimerWheel {
+public:
+    typedef uint64_t timer_id;                              ///< 0 is never a valid id
+    typedef std::function<void()> timer_callback;
+
+private:
+    struct node {
+        timer_callback cb;                                  ///< Called when timer expires
+        uint64_t expiry = 0;                                ///< Absolute tick the timer is due
+        uint32_t generation = 0;                            ///< Bumped on reuse, guards stale ids
+        int32_t prev = -1;                                  ///< Previous node in slot list
+        int32_t next = -1;                                  ///< Next node in slot list
+        int16_t level = -1;                                 ///< Level node is linked into, -1 if free
+        int16_t slot = -1;                                  ///< Slot node is linked into
+    };
+
+    std::mutex _lock;                                       ///< Guards wheel state
+    std::vector<node> _nodes;                               ///< Node pool, indices are stable
+    int32_t _free = -1;                                     ///< Head of free node list
+    int32_t _slots[TW_LEVELS][TW_SLOTS];                    ///< Head node of each slot list
+    uint64_t _tick = 0;                                     ///< Current tick
+    int64_t _origin_ms = 0;                                 ///< Time of tick 0
+    uint32_t _tick_ms = 1;                                  ///< Milliseconds per tick
+    size_t _pending = 0;                                    ///< Timers currently scheduled
+    bool _started = false;                                  ///< True once advance() has set the origin
+
+    int32_t alloc_node();
+    void link(int32_t idx);
+    void unlink(int32_t idx);
+    void cascade(int level);
+
+public:
+    /**
+     * @brief           Constructor for CTimerWheel
+     * @param tick_ms   Timer resolution in milliseconds
+     */
+    explicit CTimerWheel(uint32_t tick_ms = 1);
+
+    /**
+     * @brief           Schedule a one-shot timer
+     * @param delay_ms  Time from now until the timer fires
+     * @param cb        Called from advance() when the timer expires
+     * @return          Id to cancel the timer with
+     */
+    timer_id schedule(uint32_t delay_ms, timer_callback cb);
+
+    /**
+     * @brief       Cancel a pending timer
+     * @param id    Timer to cancel, stale or zero ids are ignored
+     * @return      True if a pending timer was cancelled
+     */
+    bool cancel(timer_id id);
+
+    /**
+     * @brief           Turn the wheel up to a point in time and fire expired timers
+     * Callbacks run without the wheel locked, so they may schedule or cancel timers.
+     * @param now_ms    Current time in milliseconds, any monotonic base
+     * @return          Number of timers fired
+     */
+    size_t advance(int64_t now_ms);
+
+    /**
+     * @brief   Turn the wheel up to the current steady_clock time
+     * @return  Number of timers fired
+     */
+    size_t advance();
+
+    size_t get_pending();
+};
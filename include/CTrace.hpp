@@ -0,0 +1,236 @@
+/**
+ * CTrace.hpp - Datagram trace capture and reading header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define TRACE_RING_SIZE (8 << 20)   // bytes buffered between senders/receivers and the writer thread
+#define TRACE_FILE_CHUNK (16 << 20) // file grows and is mapped this much at a time, multiple of the page size
+#define TRACE_IDLE_WAIT 1           // writer thread sleep when nothing is buffered (ms)
+#define TRACE_ALIGN 32              // ring records start on this boundary, at least the size of a slot header
+#define TRACE_MAGIC "VNTRACE"       // first bytes of a trace file
+#define TRACE_VERSION 1             // file format version
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef WIN32
+#include "Winsock2.h"
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+/**
+ * Start of a trace file.
+ */
+struct trace_file_header {
+    char magic[8];                  ///< TRACE_MAGIC, zero padded
+    uint32_t version;               ///< TRACE_VERSION
+    uint32_t record_header;         ///< sizeof(trace_record) when written
+    int64_t start_unix_ns;          ///< Wall clock time of time_ns 0
+};
+
+/**
+ * One datagram in a trace file, followed by len bytes of data padded to 8.
+ */
+struct trace_record {
+    int64_t time_ns;                ///< Time since the trace started (steady clock)
+    uint32_t addr;                  ///< Peer address, network order
+    uint16_t port;                  ///< Peer port, network order
+    uint8_t dir;                    ///< CTrace::TRACE_RX or CTrace::TRACE_TX
+    uint8_t reserved;
+    uint32_t len;                   ///< Datagram length
+    uint32_t reserved2;
+};
+
+/**
+ * Plain copy of a recorder's counters.
+ */
+struct trace_stats {
+    uint64_t recorded = 0;          ///< Datagrams written to the file
+    uint64_t bytes = 0;             ///< File bytes written, headers included
+    uint64_t dropped = 0;           ///< Datagrams not recorded because the ring was full
+};
+
+/**
+ * Records sent and received datagrams to an append-only trace file.
+ *
+ * record() copies the datagram into a ring shared by all calling threads and returns.
+ * Space is claimed with one compare-and-swap and the record is published with a release
+ * store, so senders and receivers never lock or wait on each other or on the disk. If
+ * the writer falls behind and the ring fills up, datagrams are dropped from the trace
+ * and counted instead of slowing the caller down. A writer thread moves records into
+ * the file through a memory mapping that grows in TRACE_FILE_CHUNK steps, and the file
+ * is cut to its real length on close. Not available on Windows.
+ */
+class CTrace {
+public:
+    enum direction : uint8_t {
+        TRACE_RX = 1,               ///< Received from peer
+        TRACE_TX = 2                ///< Sent to peer
+    };
+
+private:
+    enum slot_state : uint32_t {
+        SLOT_FREE = 0,              ///< Not written yet, the writer stops here
+        SLOT_READY = 1,             ///< Holds a record
+        SLOT_PAD = 2                ///< Filler up to the end of the ring
+    };
+
+    struct slot {
+        std::atomic<uint32_t> state;                        ///< slot_state, set last by the producer
+        uint32_t size;                                      ///< Ring bytes used, header included
+        trace_record rec;                                   ///< Record, time_ns is absolute until written
+    };
+
+    struct alignas(TRACE_ALIGN) block {
+        unsigned char bytes[TRACE_ALIGN];
+    };
+
+    /**
+     * @brief   Writer loop, runs on _thread
+     */
+    void run();
+
+    /**
+     * @brief   Move everything published in the ring to the file
+     * @return  True if anything was moved
+     */
+    bool drain();
+
+    /**
+     * @brief       Append bytes to the file, growing and remapping it as needed
+     * @param data  Bytes
+     * @param len   Length of bytes
+     * @return      True if written
+     */
+    bool write(const void *data, size_t len);
+
+    slot *at(uint64_t pos) {
+        return reinterpret_cast<slot *>(reinterpret_cast<unsigned char *>(_ring.get()) + (pos & _mask));
+    }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::unique_ptr<block[]> _ring;                         ///< Record ring, zeroed so every slot starts free
+    size_t _ring_size;                                      ///< Ring bytes, power of two
+    uint64_t _mask;                                         ///< _ring_size - 1
+    alignas(64) std::atomic<uint64_t> _head{0};             ///< Bytes claimed by producers
+    alignas(64) std::atomic<uint64_t> _tail{0};             ///< Bytes freed by the writer
+    alignas(64) std::atomic<bool> _open{false};             ///< Producers may record
+    std::atomic<bool> _running{false};                      ///< Writer thread should keep going
+    std::atomic<uint64_t> _recorded{0};
+    std::atomic<uint64_t> _bytes{0};
+    std::atomic<uint64_t> _dropped{0};
+    int64_t _start_ns = 0;                                  ///< Steady clock at open, records before it are skipped
+    int _fd = -1;                                           ///< Trace file
+    unsigned char *_map = nullptr;                          ///< Mapped chunk of the file
+    uint64_t _map_offset = 0;                               ///< File offset of _map
+    uint64_t _written = 0;                                  ///< File length so far
+    bool _failed = false;                                   ///< File couldn't grow, nothing more is written
+    std::thread _thread;                                    ///< Writer thread
+
+public:
+    /**
+     * @brief           Constructor for CTrace
+     * @param ring_size Bytes buffered for the writer, rounded up to a power of two
+     */
+    explicit CTrace(size_t ring_size = TRACE_RING_SIZE);
+    ~CTrace();
+
+    /**
+     * @brief       Create (or truncate) a trace file and start recording to it
+     * @param path  File to write
+     * @return      True if recording
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief   Stop recording, write out what is buffered and close the file
+     */
+    void close();
+
+    /**
+     * @brief   Whether record() does anything, cheap enough to check per datagram
+     * @return  True if recording
+     */
+    bool is_open() const {
+        return _open.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief       Record one datagram given in up to two parts (e.g. prefix and body), any thread
+     * @param dir   TRACE_RX or TRACE_TX
+     * @param peer  Where it came from or went to
+     * @param a     First part
+     * @param a_len Length of first part
+     * @param b     Second part, may be null
+     * @param b_len Length of second part
+     */
+    void record(direction dir, const sockaddr_in &peer, const uint8_t *a, size_t a_len,
+                const uint8_t *b = nullptr, size_t b_len = 0);
+
+    trace_stats get_stats() const;
+};
+
+/**
+ * Reads a trace file written by CTrace through a read-only mapping.
+ *
+ * Records point straight into the mapping, so reading costs no copies. A file cut short
+ * by a crash ends at the last complete record.
+ */
+class CTraceReader {
+private:
+    const unsigned char *_map = nullptr;                    ///< Whole file
+    size_t _size = 0;                                       ///< File length
+    size_t _pos = 0;                                        ///< Offset of the next record
+    trace_file_header _header{};                            ///< Copy of the file header
+
+public:
+    CTraceReader() = default;
+    ~CTraceReader();
+    CTraceReader(const CTraceReader &) = delete;
+    CTraceReader &operator=(const CTraceReader &) = delete;
+
+    /**
+     * @brief       Map a trace file
+     * @param path  File to read
+     * @return      True if it is a trace file this version can read
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    /**
+     * @brief       Read the next record
+     * @param rec   Filled with the record header
+     * @param data  Set to the datagram, valid until close()
+     * @return      True if there was a record
+     */
+    bool next(trace_record &rec, const uint8_t *&data);
+
+    /**
+     * @brief   Go back to the first record
+     */
+    void rewind();
+
+    const trace_file_header &header() const {
+        return _header;
+    }
+};
@@ -6,8 +6,11 @@
 
 #pragma once
 
-#define PING_TIMEOUT 1000
-#define UDP_MAX_SIZE 65535
+#define PING_TIMEOUT 1000           // no data from server for this long (ms) means connection is lost
+#define HANDSHAKE_RETRY 250         // ENQ resend interval while connecting or lost (ms)
+#define HEARTBEAT_INTERVAL 250      // rx idle time before a heartbeat ENQ is sent (ms)
+#define GSO_MAX_SEGMENTS 64         // kernel limit on segments in one GSO send
+#define GSO_MAX_BYTES 65000         // total datagram bytes in one GSO send
 
 #include <thread>
 #include <iomanip>
@@ -15,6 +18,9 @@
 #include <fstream>
 #include <sstream>
 #include <queue>
+#include <atomic>
+#include <memory>
+#include <functional>
 
 #ifdef WIN32
 #include "Winsock2.h"
@@ -23,39 +29,165 @@
 #include <sys/fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #endif
 
 #include <spdlog/spdlog.h>
 
-class CUDPClient {
+#include "CChunkAssembler.hpp"
+#include "CDeltaCodec.hpp"
+#include "CDispatcher.hpp"
+#include "CEndpoint.hpp"
+#include "CFrame.hpp"
+#include "CJitterBuffer.hpp"
+#include "CMessageSchema.hpp"
+#include "CMetrics.hpp"
+#include "CNetLog.hpp"
+#include "CPeerStats.hpp"
+#include "CReliableChannel.hpp"
+#include "CRpcTable.hpp"
+#include "CTimerWheel.hpp"
+#include "CTrace.hpp"
+#include "CZeroCopy.hpp"
+
+class CUDPClient : private udp_endpoint {
+public:
+    enum conn_state {
+        CONN_CLOSED,                ///< No socket
+        CONN_CONNECTING,            ///< Socket open, waiting for first ACK
+        CONN_CONNECTED,             ///< Server is responding
+        CONN_LOST                   ///< Server stopped responding, still retrying
+    };
+
+    typedef std::function<void(conn_state from, conn_state to)> state_callback;
+
 private:
     bool init_net();
-
-#ifdef WIN32
-    WSADATA _wsdat;                         ///< Winsock object
+    bool tx_frame(const std::vector<uint8_t> &body, bool control);
+    bool tx_frame(const uint8_t *body, size_t len, bool control);
+    std::string tx_prefix(const uint8_t *head, size_t head_len, const uint8_t *body, size_t len, bool control);
+    bool tx_chunks(const uint8_t *data, size_t len, size_t chunk, bool split, CZeroCopy::held *zc);
+    bool tx_segments(size_t segment, const std::string &prefixes, CZeroCopy::held *zc);
+    void trace_datagram(size_t i, const std::string &prefixes);
+#ifndef WIN32
+    ssize_t tx_msg(const msghdr *msg, size_t len, CZeroCopy::held *zc);
 #endif
+    void set_state(conn_state state);
+    void on_keepalive();
+    bool handshake();
+
     std::string _host;
     int _port = 0;
-    int _socket_fd = 0;
     bool _socket_ok = false;
-    ssize_t _bytes_moved = 0;
     ssize_t _rx_code = 0;
-    ssize_t _tx_code = 0;
     struct sockaddr_in _server_addr{};
     socklen_t _server_addr_len = 0;
     int _response_time_ms = 0;
+    std::unique_ptr<CReliableChannel> _reliable;
+    std::unique_ptr<CJitterBuffer> _jitter;
+    std::atomic<uint32_t> _tx_seq{0};
+    std::atomic<uint32_t> _chunk_id{0};
+    CPeerStats _rx_stats;
+    net_metrics _metrics = CMetrics::global().add_endpoint("udp_client");
+    std::atomic<int> _state{CONN_CLOSED};
+    std::atomic<int64_t> _last_rx_ms{0};
+    std::atomic<int64_t> _last_enq_ms{0};
+    state_callback _on_state;
+    CTimerWheel _timers;
+    CTimerWheel::timer_id _keepalive = 0;
+    CRpcTable _rpc;
+    CDispatcher _dispatcher;
+    std::atomic<uint8_t> _caps_request{0};
+    std::atomic<bool> _tx_crc{false};
+    CDeltaCodec _codec{[this](const std::vector<uint8_t> &frame) { return _socket_ok && tx_frame(frame, true); }};
+    std::vector<uint8_t> _tx_encoded;
+    std::vector<uint8_t> _rx_decoded;
+    // one datagram of a chunked send, the prefix is kept apart so the data needn't be copied
+    struct tx_datagram {
+        size_t prefix;                      ///< Offset of prefix in the prefix buffer
+        size_t prefix_len;                  ///< Length of prefix
+        const uint8_t *data;                ///< Chunk
+        size_t len;                         ///< Length of chunk
+    };
+
+    bool _gso = false;
+    std::vector<tx_datagram> _gso_batch;
+    std::string _gso_prefixes;
+    std::vector<uint8_t> _gso_buffer;       // datagram is assembled here where there is no sendmsg
+    CZeroCopy _zerocopy;
+    CTrace _trace;
 
 public:
     CUDPClient();
     ~CUDPClient();
     void setup(const std::string& host, const std::string& port);
-    void setdn() const;
+    void setdn();
     bool do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes);
     bool do_tx(const std::vector<uint8_t> &tx_buf);
+    bool do_tx(const uint8_t *tx_buf, size_t len);
+
+    // encode a CMessageSchema message on the stack and send it
+    template<typename Schema>
+    bool do_tx_msg(const typename Schema::message_type &msg) {
+        typename Schema::buffer buf;
+        Schema::encode(msg, buf.data());
+        return do_tx(buf.data(), buf.size());
+    }
+
+    // split a large payload into chunk-sized datagrams, sent with as few syscalls as GSO allows.
+    // the server's do_rx returns it whole once every piece is in
+    bool do_tx_chunks(const uint8_t *data, size_t len, size_t chunk);
+    bool do_tx_chunks(const std::vector<uint8_t> &tx_buf, size_t chunk);
+
+    // use UDP_SEGMENT for do_tx_chunks, call after setup(). returns false if the kernel can't
+    bool enable_gso(bool enable = true);
+
+    // do_tx (chunk 0) or do_tx_chunks without copying tx_buf if zero-copy is on and the sends are
+    // large enough. the buffer comes back through zerocopy().set_release_callback() when done
+    bool do_tx_zerocopy(std::vector<uint8_t> &&tx_buf, size_t chunk = 0);
+
+    // send with MSG_ZEROCOPY from sends of threshold bytes up, call after every setup(). best with GSO
+    bool enable_zerocopy(bool enable = true, size_t threshold = ZC_THRESHOLD);
+    CZeroCopy &zerocopy();
+
+    // record every datagram sent and received to a trace file, an empty path stops recording
+    bool enable_trace(const std::string &path);
+    CTrace &trace();
+
     bool ping();
+    void service();
+    void set_state_callback(state_callback cb);
+
+    void enable_reliable(size_t window = RC_WINDOW_DEFAULT);
+    bool do_tx_reliable(const std::vector<uint8_t> &tx_buf);
+    bool do_rx_reliable(std::vector<uint8_t> &rx_buf, long &rx_bytes);
+    void service_reliable();
+
+    // hold received messages back and release them in order. a server reply carries the timestamp of the
+    // datagram it answers, so replies play out on our own send cadence, delayed by the round trip plus a margin.
+    // call before the rx thread starts. do_rx then only returns messages without a sequence number
+    void enable_jitter_buffer(size_t capacity = JB_CAPACITY, int64_t min_delay_ms = JB_MIN_DELAY, int64_t max_delay_ms = JB_MAX_DELAY);
+    bool do_rx_playout(std::vector<uint8_t> &rx_buf, long &rx_bytes);
+    jitter_stats get_jitter_stats() const;
+
+    std::future<std::vector<uint8_t>> call(const std::vector<uint8_t> &payload, uint32_t timeout_ms = RPC_TIMEOUT);
+
+    using udp_endpoint::set_pacing;
+
+    // ask for the payload codec (NET_CAP_*) from the next handshake on, 0 turns it off
+    void enable_compression(uint8_t caps = NET_CAP_DELTA | NET_CAP_LZ);
+    uint8_t get_compression();
+
+    // ask for a CRC32C on every datagram from the next handshake on
+    void enable_checksum(bool enable = true);
+    bool get_checksum();
+
+    CDispatcher &dispatcher();
 
     bool get_socket_status();
+    conn_state get_state() const;
     int get_last_response_time();
+    peer_stats get_rx_stats() const;
 };
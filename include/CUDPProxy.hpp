@@ -0,0 +1,137 @@
+/**
+ * CUDPProxy.hpp - Impairing UDP proxy header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define PROXY_MAX_CLIENTS 16        // clients that get their own upstream socket
+#define PROXY_CLIENT_IDLE 30000     // a client's socket is closed after this long (ms) without traffic either way
+#define PROXY_MAX_QUEUED 65536      // packets waiting for delivery, more are dropped
+#define PROXY_IDLE_WAIT 100         // poll timeout while nothing is scheduled (ms)
+#define PROXY_BUFFER_SIZE 65536     // receive buffer, fits any datagram
+#define PROXY_READ_BATCH 64         // datagrams read from one socket before deliveries are checked again
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#include "Winsock2.h"
+#include <ws2tcpip.h>
+#else
+#include <poll.h>
+#include <sys/fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include "CImpairment.hpp"
+#include "CNetLog.hpp"
+
+/**
+ * UDP proxy that sits between clients and a server and impairs the traffic.
+ *
+ * Clients send to the proxy's port instead of the server's. Each client gets its own
+ * upstream socket, so the server still sees one address per client. Packets in each
+ * direction go through a CImpairment and are sent on when it says they arrive. One
+ * thread does all forwarding, so the proxy can run inside a test program next to a
+ * CUDPClient and CUDPServer or on its own on loopback. Needs no privileges.
+ */
+class CUDPProxy {
+private:
+    struct client {
+        sockaddr_in addr;                                   ///< Client address
+        int fd;                                             ///< Socket towards the server
+        int64_t last_us;                                    ///< Last datagram to or from the client
+    };
+
+    struct pending {
+        int fd;                                             ///< Socket to send from
+        sockaddr_in dst;                                    ///< Where to
+        std::vector<uint8_t> data;                          ///< Datagram
+    };
+
+    /**
+     * @brief   Forwarding loop, runs on _thread
+     */
+    void run();
+
+    /**
+     * @brief           Read what is waiting on a socket and schedule it
+     * @param fd        Socket to read
+     * @param upstream  True if fd is the listening socket (client to server)
+     */
+    void read_some(int fd, bool upstream);
+
+    /**
+     * @brief       Find or create the upstream socket of a client
+     * @param addr  Client address
+     * @return      Client, null if there are too many
+     */
+    client *get_client(const sockaddr_in &addr);
+
+    /**
+     * @brief       Close the sockets of clients that have gone quiet and free their slots
+     * @param now   Current time (us)
+     */
+    void expire_clients(int64_t now);
+
+    static int64_t now_us();
+    static void close_fd(int fd);
+
+#ifdef WIN32
+    WSADATA _wsdat;                                         ///< Winsock object
+#endif
+    CImpairment _up;                                        ///< Client to server
+    CImpairment _down;                                      ///< Server to client
+    int _listen_fd = -1;                                    ///< Socket clients send to
+    sockaddr_in _server_addr{};                             ///< Server to forward to
+    std::vector<client> _clients;                           ///< Known clients, forwarding thread only
+    std::multimap<int64_t, pending> _queue;                 ///< Scheduled deliveries by time, FIFO on ties
+    std::vector<uint8_t> _buffer;                           ///< Receive buffer
+    std::atomic<bool> _running{false};                      ///< Forwarding thread should keep going
+    std::atomic<uint64_t> _overflowed{0};                   ///< Dropped because PROXY_MAX_QUEUED were waiting
+    std::thread _thread;                                    ///< Forwarding thread
+
+public:
+    /**
+     * @brief       Constructor for CUDPProxy
+     * @param up    Impairment from clients to the server
+     * @param down  Impairment from the server to clients
+     */
+    explicit CUDPProxy(const impairment_config &up = impairment_config(), const impairment_config &down = impairment_config());
+    ~CUDPProxy();
+
+    /**
+     * @brief               Bind the listening port and start forwarding
+     * @param listen_port   Port clients send to
+     * @param host          Server address
+     * @param port          Server port
+     * @return              True if started
+     */
+    bool start(const std::string &listen_port, const std::string &host, const std::string &port);
+
+    /**
+     * @brief   Stop forwarding and close all sockets, scheduled packets are dropped
+     */
+    void stop();
+
+    /**
+     * @brief       Change both impairments, each starts over from its seed
+     * @param up    Impairment from clients to the server
+     * @param down  Impairment from the server to clients
+     */
+    void configure(const impairment_config &up, const impairment_config &down);
+
+    impairment_stats get_up_stats();
+    impairment_stats get_down_stats();
+    uint64_t get_overflowed();
+};
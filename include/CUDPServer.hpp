@@ -6,7 +6,7 @@
 
 #pragma once
 
-#define UDP_MAX_SIZE 65535
+#define SESSION_TIMEOUT 5000        // reliable session is dropped after this long (ms) without data from the client
 
 #include <thread>
 #include <iomanip>
@@ -14,6 +14,11 @@
 #include <fstream>
 #include <sstream>
 #include <queue>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 #ifdef WIN32
 #include "Winsock2.h"
@@ -21,25 +26,69 @@
 #else
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #endif
 
 #include <spdlog/spdlog.h>
 
-class CUDPServer {
+#include "CChunkAssembler.hpp"
+#include "CDeltaCodec.hpp"
+#include "CDispatcher.hpp"
+#include "CEndpoint.hpp"
+#include "CFrame.hpp"
+#include "CMessageSchema.hpp"
+#include "CMetrics.hpp"
+#include "CNetLog.hpp"
+#include "CPeerStats.hpp"
+#include "CReliableChannel.hpp"
+#include "CRpcTable.hpp"
+#include "CTimerWheel.hpp"
+#include "CTrace.hpp"
+
+class CUDPServer : private udp_endpoint {
+public:
+    /**
+     * Handles an RPC call on the rx thread. Return true to send reply straight away,
+     * or false to answer later with do_tx_reply().
+     */
+    typedef std::function<bool(const std::vector<uint8_t> &request, const sockaddr_in &src, uint32_t id,
+                               std::vector<uint8_t> &reply)> rpc_handler;
+
 private:
-#ifdef WIN32
-    WSADATA _wsdat;                         ///< Winsock object
-#endif
+    struct session {
+        std::shared_ptr<CReliableChannel> channel;          ///< Reliable channel for this client, null until used
+        std::shared_ptr<CDeltaCodec> codec;                 ///< Payload codec, null unless the client asked for one
+        uint8_t caps = 0;                                   ///< Capabilities agreed on in the last handshake
+        std::shared_ptr<std::atomic<bool>> crc;             ///< Client agreed to CRC32C, senders read it without the lock
+        int64_t last_rx_ms = 0;                             ///< Last time anything came in from the client
+    };
+
     int _port = 0;                          ///< Port to listen on
-    int _socket_fd = 0;                     ///< Socket file descriptor
     ssize_t _rx_code = 0;                   ///< Size of received data
+    bool _gro = false;                      ///< Socket may return several datagrams per read
+    size_t _gro_offset = 0;                 ///< Start of next datagram in receive buffer
+    size_t _gro_segment = 0;                ///< Size of each datagram in receive buffer, the last may be shorter
     std::queue<std::string> _rx_time_queue; ///< Queue containing times of receive data
     struct sockaddr_in _server_addr{};      ///< Server info struct
     struct sockaddr_in _client_addr{};      ///< Client info struct
     socklen_t _client_addr_len = 0;         ///< Length of client address
-    std::vector<uint8_t> _recv_buffer;      ///< Buffer for received data
+    std::string _rx_time;                   ///< Timestamp of the datagram being handled
+    CDispatcher _dispatcher;                ///< Handlers for control, protocol and app message types
+    size_t _reliable_window = 0;            ///< Reliable channel window, 0 if disabled
+    std::mutex _session_lock;               ///< Guards session map
+    std::map<uint64_t, session> _sessions;  ///< Reliable channel and codec per client
+    uint8_t _caps = 0;                      ///< Capabilities offered to clients (NET_CAP_*)
+    std::vector<uint8_t> _tx_encoded;       ///< Codec output for do_tx
+    std::vector<uint8_t> _rx_decoded;       ///< Codec output for do_rx
+    CChunkAssembler _chunks;                ///< Puts chunked client messages back together, rx thread only
+    std::vector<uint8_t> _rx_assembled;     ///< Message completed by the last chunk
+    CTimerWheel _timers;                    ///< Session expiry timers, driven by service()
+    rpc_handler _rpc_handler;               ///< Answers RPC calls, calls are dropped if unset
+    CTrace _trace;                          ///< Records datagrams when a trace file is open
+    CPeerStatsTable _peer_stats;            ///< Sequence numbers and rx stats per client
+    net_metrics _metrics = CMetrics::global().add_endpoint("udp_server"); ///< Ids of this server's metrics
 
     /**
      * @brief Internal function to init networking stuff
@@ -47,6 +96,64 @@ private:
      */
     bool init_net();
 
+    /**
+     * @brief   Read the socket into the receive buffer, with GRO possibly several datagrams at once
+     * @return  True if something was read
+     */
+    bool rx_datagrams();
+
+    /**
+     * @brief           Prefix data with a timestamp and send it
+     * @param time      Timestamp to prefix
+     * @param tx_buf    Buffer containing data to send
+     * @param dst       struct containing destination
+     * @param control   True if tx_buf is a library frame, false for app data
+     * @param crc       True to add a CRC32C, see wants_crc()
+     * @return          True if data was sent, false otherwise
+     */
+    bool tx_frame(const std::string &time, const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst, bool control, bool crc);
+    bool tx_frame(const std::string &time, const uint8_t *tx_buf, size_t len, const sockaddr_in &dst, bool control, bool crc);
+
+    /**
+     * @brief       Get session for a client, creating it if needed (lock must be held)
+     * @param peer  struct containing client address
+     * @return      Session for client
+     */
+    session &get_session(const sockaddr_in &peer);
+
+    /**
+     * @brief       Keep a client's session alive, if it has one
+     * @param peer  struct containing client address
+     */
+    void touch_session(const sockaddr_in &peer);
+
+    /**
+     * @brief       Get reliable channel for a client, creating it if needed
+     * @param peer  struct containing client address
+     * @return      Reliable channel for client
+     */
+    std::shared_ptr<CReliableChannel> get_reliable_peer(const sockaddr_in &peer);
+
+    /**
+     * @brief       Get payload codec for a client
+     * @param peer  struct containing client address
+     * @return      Codec for client, null if it didn't ask for one
+     */
+    std::shared_ptr<CDeltaCodec> get_codec(const sockaddr_in &peer);
+
+    /**
+     * @brief       Check if a client agreed to CRC32C in its handshake (takes the session lock)
+     * @param peer  struct containing client address
+     * @return      True if datagrams to it should carry a CRC32C
+     */
+    bool wants_crc(const sockaddr_in &peer);
+
+    /**
+     * @brief           Drop a session if the client has gone quiet, otherwise check again later
+     * @param key       Client key
+     */
+    void expire_session(uint64_t key);
+
 public:
     /**
      * @brief Constructor for CUDPServer
@@ -65,9 +172,9 @@ public:
     void setup(const std::string& port);
 
     /**
-     * @brief Close and clean up UDP server
+     * @brief Send EOT to clients with a session, then close and clean up UDP server, safe to call more than once
      */
-    void setdn() const;
+    void setdn();
 
     /**
      * @brief           Receive data (nonblocking)
@@ -87,4 +194,134 @@ public:
      * @return          True if data was sent, false otherwise
      */
     bool do_tx(const std::vector<uint8_t> &tx_buf, sockaddr_in &dst);
+
+    /**
+     * @brief           Send data without copying it into a vector first
+     * @param tx_buf    Pointer to data to send
+     * @param len       Length of data
+     * @param dst       struct containing destination
+     * @return          True if data was sent, false otherwise
+     */
+    bool do_tx(const uint8_t *tx_buf, size_t len, const sockaddr_in &dst);
+
+    /**
+     * @brief           Encode a CMessageSchema message on the stack and send it
+     * @param msg       Message to send
+     * @param dst       struct containing destination
+     * @return          True if data was sent, false otherwise
+     */
+    template<typename Schema>
+    bool do_tx_msg(const typename Schema::message_type &msg, const sockaddr_in &dst) {
+        typename Schema::buffer buf;
+        Schema::encode(msg, buf.data());
+        return do_tx(buf.data(), buf.size(), dst);
+    }
+
+    /**
+     * @brief           Enable reliable delivery channel alongside unreliable data
+     * @param window    Max frames in flight per client
+     */
+    void enable_reliable(size_t window = RC_WINDOW_DEFAULT);
+
+    /**
+     * @brief           Send data over the reliable channel
+     * @param tx_buf    Buffer containing data to send
+     * @param dst       struct containing destination
+     * @return          True if data was sent, false if window is full or channel is disabled
+     */
+    bool do_tx_reliable(const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst);
+
+    /**
+     * @brief           Pop the next in-order message from any client's reliable channel
+     * @param rx_buf    Buffer to receive data into
+     * @param src       struct containing info about data source
+     * @param rx_bytes  Number of bytes received
+     * @return          True if data was available, false otherwise
+     */
+    bool do_rx_reliable(std::vector<uint8_t> &rx_buf, sockaddr_in &src, long &rx_bytes);
+
+    /**
+     * @brief Retransmit expired reliable frames for all clients
+     * Meant to run in a loop in a thread.
+     */
+    void service_reliable();
+
+    /**
+     * @brief           Set the handler that answers RPC calls
+     * Must be set before do_rx starts running.
+     * @param handler   Called for every incoming call
+     */
+    void set_rpc_handler(rpc_handler handler);
+
+    /**
+     * @brief           Send a deferred RPC reply
+     * @param id        Request id passed to the handler
+     * @param tx_buf    Reply payload
+     * @param dst       struct containing destination
+     * @return          True if data was sent, false otherwise
+     */
+    bool do_tx_reply(uint32_t id, const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst);
+
+    /**
+     * @brief       Offer the payload codec to clients that ask for it in their handshake
+     * Clients get the capabilities both sides support. Call before do_rx starts running.
+     * @param caps  Capabilities to offer (NET_CAP_*), 0 to turn it off
+     */
+    void enable_compression(uint8_t caps = NET_CAP_DELTA | NET_CAP_LZ);
+
+    /**
+     * @brief           Let one read return many same-sized datagrams (UDP_GRO), do_rx still returns them one by one
+     * Call after setup(), before do_rx starts running.
+     * @param enable    True to turn GRO on
+     * @return          True if the requested mode is active, false if the kernel doesn't support GRO
+     */
+    bool enable_gro(bool enable = true);
+
+    /**
+     * @brief           Offer a CRC32C on every datagram to clients that ask for it in their handshake
+     * Received CRCs are always checked. Call before do_rx starts running.
+     * @param enable    True to offer checksums
+     */
+    void enable_checksum(bool enable = true);
+
+    /**
+     * @brief   Get the dispatcher, to handle app message types on the rx thread
+     * Messages with a handler are not returned by do_rx. Register before do_rx starts running.
+     * @return  Dispatcher for this server
+     */
+    CDispatcher &dispatcher();
+
+    /**
+     * @brief       Record every datagram received and sent, with times and client addresses, to a trace file
+     * Recording copies each datagram into a buffer drained by a writer thread and never blocks.
+     * Replay a trace with test-trace-replay.
+     * @param path  File to write, empty to stop recording
+     * @return      True if recording (or stopped)
+     */
+    bool enable_trace(const std::string &path);
+
+    /**
+     * @brief   Get the trace recorder, for its stats
+     * @return  Recorder for this server
+     */
+    CTrace &trace();
+
+    /**
+     * @brief Run expired timers and reliable retransmits
+     * Meant to run in a loop in a thread.
+     */
+    void service();
+
+    /**
+     * @brief       Get loss, reorder and jitter stats of every client seen so far
+     * A client's stats are dropped with its session. Does not lock, safe to call while do_rx runs in another thread.
+     * @param peers Filled with client addresses
+     * @param stats Filled with stats, same order as peers
+     */
+    void get_peer_stats(std::vector<sockaddr_in> &peers, std::vector<peer_stats> &stats) const;
+
+    /**
+     * @brief   Pace outgoing data to a rate instead of sending in bursts, see BasicEndpoint
+     */
+    using udp_endpoint::set_pacing;
 };
@@ -0,0 +1,165 @@
+/**
+ * CZeroCopy.hpp - MSG_ZEROCOPY send bookkeeping header
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#pragma once
+
+#define ZC_THRESHOLD 16384          // sends smaller than this are copied, pinning pages costs more
+#define ZC_MAX_FRAGS 17             // pages one zero-copy UDP send can pin (MAX_SKB_FRAGS)
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#endif
+#endif
+
+/**
+ * Tracks buffers lent to the kernel by MSG_ZEROCOPY sends on one socket.
+ *
+ * With SO_ZEROCOPY the kernel sends straight from the caller's pages instead of copying
+ * them, so the buffer must stay untouched until the kernel reports the send complete on
+ * the socket's error queue. A buffer is moved in with hold(), sent with any number of
+ * send() calls, then sealed. reap() reads the completions and hands every buffer whose
+ * sends have all finished back through the release callback, so the application can
+ * reuse it. The kernel numbers successful zero-copy sends 0, 1, 2, ... per socket and
+ * reports them in ranges, which is how completions are matched to buffers.
+ *
+ * Linux only (4.14 for TCP, 5.0 for UDP). Elsewhere enable() fails and callers copy.
+ */
+class CZeroCopy {
+public:
+    typedef std::function<void(std::vector<uint8_t> &&buf)> release_callback;
+
+    /**
+     * A buffer the kernel may still be reading from.
+     */
+    struct held {
+        std::vector<uint8_t> buf;   ///< Payload, handed back once every send has completed
+        std::string scratch;        ///< Other bytes the sends point into, e.g. prefixes, kept as long as buf
+        uint32_t first_id = 0;      ///< Kernel id of the first zero-copy send
+        uint32_t sends = 0;         ///< Zero-copy sends made from this buffer
+        uint32_t completed = 0;     ///< Sends the kernel has finished with
+        bool sealed = false;        ///< No more sends will be made
+    };
+
+private:
+    /**
+     * @brief   Remove finished buffers, lock must be held
+     * @param   out Receives the removed buffers
+     */
+    void collect(std::vector<std::vector<uint8_t>> &out);
+
+    /**
+     * @brief   Hand buffers back, lock must not be held
+     * @param   bufs Buffers to release
+     */
+    void release_all(std::vector<std::vector<uint8_t>> &bufs);
+
+    std::mutex _lock;                                       ///< Guards everything below
+    int _fd = -1;                                           ///< Socket the sends go out on
+    std::atomic<bool> _enabled{false};                      ///< SO_ZEROCOPY is set
+    std::atomic<size_t> _threshold{ZC_THRESHOLD};           ///< Smallest send worth doing without a copy
+    release_callback _on_release;                           ///< Gets buffers back
+    uint32_t _next_id = 0;                                  ///< Kernel id of the next zero-copy send
+    std::list<held> _held;                                  ///< Buffers lent out, list so references stay valid
+    uint64_t _completed = 0;                                ///< Zero-copy sends completed
+    uint64_t _copied = 0;                                   ///< Completed sends the kernel ended up copying anyway
+
+public:
+    /**
+     * @brief           Turn zero-copy sends on or off for a socket
+     * @param fd        Socket
+     * @param enable    False turns it off, buffers already lent out still come back
+     * @param threshold Smallest send worth doing without a copy
+     * @return          True if the socket accepted SO_ZEROCOPY
+     */
+    bool enable(int fd, bool enable = true, size_t threshold = ZC_THRESHOLD);
+
+    /**
+     * @brief       Check if a send of some size should be zero-copy
+     * @param len   Bytes in one send call
+     * @return      True if enabled and len reaches the threshold
+     */
+    bool use_for(size_t len) const;
+
+    /**
+     * @brief       Set the callback that gets buffers back, it runs on whichever thread reaps
+     * @param cb    Callback, may be empty to just free them
+     */
+    void set_release_callback(release_callback cb);
+
+    /**
+     * @brief       Take ownership of a buffer about to be sent zero-copy
+     * @param buf   Buffer, moved from
+     * @return      Entry to send from and seal, stays valid until sealed
+     */
+    held &hold(std::vector<uint8_t> &&buf);
+
+#ifndef WIN32
+    /**
+     * @brief       Send from a held buffer with MSG_ZEROCOPY
+     * @param h     Entry returned by hold()
+     * @param msg   Message whose iovecs point into h.buf or h.scratch
+     * @param flags Other sendmsg flags
+     * @return      Result of sendmsg
+     */
+    ssize_t send(held &h, const msghdr *msg, int flags = 0);
+#endif
+
+    /**
+     * @brief   Mark a held buffer as fully sent, it is released once the kernel is done
+     * @param   h Entry returned by hold()
+     */
+    void seal(held &h);
+
+    /**
+     * @brief       Hand a buffer that was copied back right away
+     * @param buf   Buffer, moved from
+     */
+    void release(std::vector<uint8_t> &&buf);
+
+    /**
+     * @brief   Read completions from the error queue and release finished buffers
+     * @return  True if any completion was read
+     */
+    bool reap();
+
+    /**
+     * @brief   Forget the socket after it was closed, its completions will never come
+     * Every held buffer is handed back through the release callback, and send ids start
+     * over from 0 for the next socket. Zero-copy is off until enable() is called again.
+     */
+    void reset();
+
+    /**
+     * @brief       Count the pages a piece of a send pins, each is a fragment to the kernel
+     * @param data  Start of piece
+     * @param len   Length of piece
+     * @return      Pages spanned
+     */
+    static size_t frags(const void *data, size_t len);
+
+    /**
+     * @brief       Most pages a piece of some length can span, wherever it starts
+     * @param len   Length of piece
+     * @return      Pages spanned in the worst case
+     */
+    static size_t max_frags(size_t len);
+
+    bool is_enabled() const;
+    size_t get_held();
+    uint64_t get_completed();
+    uint64_t get_copied();
+};
@@ -0,0 +1,131 @@
+/**
+ * CChunkAssembler.cpp - Reassembly of messages split by do_tx_chunks code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CChunkAssembler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "../include/CNetLog.hpp"
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static void set_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+void CChunkAssembler::make_header(uint8_t *out, uint16_t id, uint16_t index, uint16_t count) {
+    out[0] = CH_TYPE_CHUNK;
+    set_u16(out + 1, id);
+    set_u16(out + 3, index);
+    set_u16(out + 5, count);
+}
+
+void CChunkAssembler::on_rx(uint64_t peer, const uint8_t *data, size_t len, int64_t now_ms) {
+    _ready = false;
+    if (len < CH_HEADER_SIZE) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Short chunk frame received");
+        return;
+    }
+    uint16_t id = get_u16(data + 1);
+    uint16_t index = get_u16(data + 3);
+    uint16_t count = get_u16(data + 5);
+    const uint8_t *piece = data + CH_HEADER_SIZE;
+    size_t piece_len = len - CH_HEADER_SIZE;
+    if (!count || index >= count) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Chunk index out of range");
+        return;
+    }
+
+    // a message in one piece needs no bookkeeping
+    if (count == 1) {
+        _done.assign(piece, piece + piece_len);
+        _ready = true;
+        _completed++;
+        return;
+    }
+
+    // give up on messages whose pieces stopped coming, then look for this one
+    for (size_t i = 0; i < _partials.size();) {
+        if (now_ms - _partials[i].last_ms > CH_TIMEOUT) {
+            drop(i);
+        } else {
+            i++;
+        }
+    }
+    size_t idx = 0;
+    while (idx < _partials.size() && !(_partials[idx].peer == peer && _partials[idx].id == id)) idx++;
+
+    // the id came round again or the sender restarted, the old pieces can't belong to it
+    if (idx < _partials.size() && _partials[idx].count != count) {
+        drop(idx);
+        idx = _partials.size();
+    }
+
+    if (idx == _partials.size()) {
+        if (_partials.size() >= CH_MAX_PARTIAL) {
+            size_t oldest = 0;
+            for (size_t i = 1; i < _partials.size(); i++) {
+                if (_partials[i].last_ms < _partials[oldest].last_ms) oldest = i;
+            }
+            drop(oldest);
+            idx = _partials.size();
+        }
+        _partials.emplace_back();
+        partial &p = _partials.back();
+        p.peer = peer;
+        p.id = id;
+        p.count = count;
+        p.pieces.resize(count);
+        p.have.resize(count);
+    }
+
+    partial &p = _partials[idx];
+    p.last_ms = now_ms;
+    if (p.have[index]) return;
+    if (_bytes + piece_len > CH_MAX_BYTES) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Chunk reassembly buffer full, dropping message");
+        drop(idx);
+        return;
+    }
+    p.pieces[index].assign(piece, piece + piece_len);
+    p.have[index] = true;
+    p.received++;
+    p.bytes += piece_len;
+    _bytes += piece_len;
+    if (p.received < p.count) return;
+
+    _done.clear();
+    _done.reserve(p.bytes);
+    for (const auto &part : p.pieces) _done.insert(_done.end(), part.begin(), part.end());
+    _ready = true;
+    _completed++;
+    _bytes -= p.bytes;
+    _partials.erase(_partials.begin() + (long) idx);
+}
+
+bool CChunkAssembler::pop(std::vector<uint8_t> &out) {
+    if (!_ready) return false;
+    _ready = false;
+    out.swap(_done);
+    return true;
+}
+
+void CChunkAssembler::drop(size_t idx) {
+    _bytes -= _partials[idx].bytes;
+    _partials.erase(_partials.begin() + (long) idx);
+    _dropped++;
+}
+
+uint64_t CChunkAssembler::get_completed() const {
+    return _completed;
+}
+
+uint64_t CChunkAssembler::get_dropped() const {
+    return _dropped;
+}
@@ -0,0 +1,139 @@
+/**
+ * CCompressor.cpp - LZ4-style block compressor code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CCompressor.hpp"
+
+#include <cstring>
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash32(uint32_t v) {
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+static void put_length(std::vector<uint8_t> &out, size_t len) {
+    while (len >= 255) {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back((uint8_t) len);
+}
+
+static bool get_length(const uint8_t *src, size_t len, size_t &ip, size_t &value) {
+    uint8_t b;
+    do {
+        if (ip >= len) return false;
+        b = src[ip++];
+        value += b;
+    } while (b == 255);
+    return true;
+}
+
+// one sequence: literals, then a match unless this is the last sequence
+static void put_sequence(std::vector<uint8_t> &out, const uint8_t *lit, size_t lit_len, size_t offset, size_t match_len) {
+    size_t match_code = match_len ? match_len - LZ_MIN_MATCH : 0;
+    out.push_back((uint8_t) (((lit_len < 15 ? lit_len : 15) << 4) | (match_code < 15 ? match_code : 15)));
+    if (lit_len >= 15) put_length(out, lit_len - 15);
+    out.insert(out.end(), lit, lit + lit_len);
+    if (!match_len) return;
+    out.push_back((uint8_t) offset);
+    out.push_back((uint8_t) (offset >> 8));
+    if (match_code >= 15) put_length(out, match_code - 15);
+}
+
+void CCompressor::compress(const uint8_t *src, size_t len, const uint8_t *dict, size_t dict_len, std::vector<uint8_t> &out) {
+    // dictionary and data side by side, so matches can cross from one into the other
+    static thread_local std::vector<uint8_t> window;
+    if (dict_len > LZ_MAX_OFFSET) {
+        dict += dict_len - LZ_MAX_OFFSET;
+        dict_len = LZ_MAX_OFFSET;
+    }
+    window.assign(dict, dict + dict_len);
+    window.insert(window.end(), src, src + len);
+    const uint8_t *buf = window.data();
+    size_t end = window.size();
+
+    // positions + 1, so 0 means empty
+    uint32_t table[1 << LZ_HASH_BITS] = {};
+    for (size_t p = 0; p + LZ_MIN_MATCH <= dict_len; p++) table[hash32(read32(buf + p))] = (uint32_t) p + 1;
+
+    out.clear();
+    out.reserve(bound(len));
+    size_t anchor = dict_len;
+    size_t p = dict_len;
+
+    // try the last offset first, with a dictionary it starts out lining each byte up with
+    // the same position in the previous message, which is where similar messages match
+    size_t rep_offset = dict_len;
+    while (p + LZ_MIN_MATCH <= end) {
+        uint32_t h = hash32(read32(buf + p));
+        size_t cand = table[h];
+        table[h] = (uint32_t) p + 1;
+        if (rep_offset && rep_offset <= p && read32(buf + p - rep_offset) == read32(buf + p)) {
+            cand = p - rep_offset;
+        } else if (!cand || p - (cand - 1) > LZ_MAX_OFFSET || read32(buf + cand - 1) != read32(buf + p)) {
+            p++;
+            continue;
+        } else {
+            cand--;
+        }
+        rep_offset = p - cand;
+
+        // extend the match as far as it goes, overlapping is fine
+        size_t match_len = LZ_MIN_MATCH;
+        while (p + match_len < end && buf[cand + match_len] == buf[p + match_len]) match_len++;
+
+        put_sequence(out, buf + anchor, p - anchor, p - cand, match_len);
+        p += match_len;
+        anchor = p;
+    }
+    put_sequence(out, buf + anchor, end - anchor, 0, 0);
+}
+
+bool CCompressor::decompress(const uint8_t *src, size_t len, const uint8_t *dict, size_t dict_len, size_t max_len, std::vector<uint8_t> &out) {
+    out.clear();
+    size_t ip = 0;
+    while (ip < len) {
+        uint8_t token = src[ip++];
+
+        // literals
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !get_length(src, len, ip, lit_len)) return false;
+        if (lit_len > len - ip || lit_len > max_len - out.size()) return false;
+        out.insert(out.end(), src + ip, src + ip + lit_len);
+        ip += lit_len;
+
+        // last sequence ends with its literals
+        if (ip == len) break;
+
+        // match
+        if (len - ip < 2) return false;
+        size_t offset = src[ip] | ((size_t) src[ip + 1] << 8);
+        ip += 2;
+        size_t match_len = token & 0x0F;
+        if (match_len == 15 && !get_length(src, len, ip, match_len)) return false;
+        match_len += LZ_MIN_MATCH;
+        if (!offset || offset > dict_len + out.size() || match_len > max_len - out.size()) return false;
+
+        // start in the dictionary if the offset reaches back past the output
+        size_t from = dict_len + out.size() - offset;
+        while (match_len && from < dict_len) {
+            out.push_back(dict[from++]);
+            match_len--;
+        }
+        from -= dict_len;
+        while (match_len--) out.push_back(out[from++]);
+    }
+    return true;
+}
+
+size_t CCompressor::bound(size_t len) {
+    return len + len / 255 + 16;
+}
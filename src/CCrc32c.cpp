@@ -0,0 +1,191 @@
+/**
+ * CCrc32c.cpp - CRC32C (Castagnoli) checksum code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CCrc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_X86
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_ARM
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+typedef std::array<std::array<uint32_t, 256>, 8> crc_tables;
+
+// table[0] is the classic byte table, table[k] advances a byte through k more zero bytes
+static constexpr crc_tables make_tables() {
+    crc_tables t{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ (CRC32C_POLY & (0U - (c & 1)));
+        t[0][i] = c;
+    }
+    for (size_t i = 0; i < 256; i++) {
+        for (size_t k = 1; k < 8; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+    }
+    return t;
+}
+
+static constexpr crc_tables tables = make_tables();
+
+// a * b modulo the polynomial, both in reflected bit order
+static constexpr uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1U << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if (!(a & (m - 1))) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(8n) modulo the polynomial, multiplying a CRC state by it appends n zero bytes
+static constexpr uint32_t x8nmodp(size_t n) {
+    uint32_t p = 1U << 31;
+    uint32_t x2k = 1U << 30;
+    for (int k = 0; k < 3; k++) x2k = multmodp(x2k, x2k);
+    while (n) {
+        if (n & 1) p = multmodp(x2k, p);
+        n >>= 1;
+        x2k = multmodp(x2k, x2k);
+    }
+    return p;
+}
+
+// shift that moves a lane's state past the two lanes after it
+static constexpr uint32_t lane_shift = x8nmodp(CRC32C_LANE);
+
+// the crc arguments below are raw register states, without the initial and final inversion
+
+static uint32_t crc_sw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+        uint32_t hi = (uint32_t) p[4] | ((uint32_t) p[5] << 8) | ((uint32_t) p[6] << 16) | ((uint32_t) p[7] << 24);
+        crc = tables[7][lo & 0xFF] ^ tables[6][(lo >> 8) & 0xFF] ^ tables[5][(lo >> 16) & 0xFF] ^ tables[4][lo >> 24] ^
+              tables[3][hi & 0xFF] ^ tables[2][(hi >> 8) & 0xFF] ^ tables[1][(hi >> 16) & 0xFF] ^ tables[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = tables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef CRC32C_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    uint64_t v[3];
+
+    // three streams in parallel, crc32 has a latency of 3 but issues every cycle
+    while (len >= 3 * CRC32C_LANE) {
+        uint64_t a = crc, b = 0, c = 0;
+        for (size_t i = 0; i < CRC32C_LANE; i += 8) {
+            std::memcpy(v, p + i, 8);
+            std::memcpy(v + 1, p + CRC32C_LANE + i, 8);
+            std::memcpy(v + 2, p + 2 * CRC32C_LANE + i, 8);
+            a = _mm_crc32_u64(a, v[0]);
+            b = _mm_crc32_u64(b, v[1]);
+            c = _mm_crc32_u64(c, v[2]);
+        }
+        crc = multmodp(lane_shift, multmodp(lane_shift, (uint32_t) a) ^ (uint32_t) b) ^ (uint32_t) c;
+        p += 3 * CRC32C_LANE;
+        len -= 3 * CRC32C_LANE;
+    }
+
+    uint64_t a = crc;
+    while (len >= 8) {
+        std::memcpy(v, p, 8);
+        a = _mm_crc32_u64(a, v[0]);
+        p += 8;
+        len -= 8;
+    }
+    crc = (uint32_t) a;
+    while (len--) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+static bool has_hw() {
+    return __builtin_cpu_supports("sse4.2");
+}
+
+static const char *hw_name = "sse4.2";
+#endif
+
+#ifdef CRC32C_ARM
+#ifdef __clang__
+__attribute__((target("crc")))
+#else
+__attribute__((target("+crc")))
+#endif
+static uint32_t crc_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    uint64_t v[3];
+
+    // three streams in parallel to hide the instruction's latency
+    while (len >= 3 * CRC32C_LANE) {
+        uint32_t a = crc, b = 0, c = 0;
+        for (size_t i = 0; i < CRC32C_LANE; i += 8) {
+            std::memcpy(v, p + i, 8);
+            std::memcpy(v + 1, p + CRC32C_LANE + i, 8);
+            std::memcpy(v + 2, p + 2 * CRC32C_LANE + i, 8);
+            a = __crc32cd(a, v[0]);
+            b = __crc32cd(b, v[1]);
+            c = __crc32cd(c, v[2]);
+        }
+        crc = multmodp(lane_shift, multmodp(lane_shift, a) ^ b) ^ c;
+        p += 3 * CRC32C_LANE;
+        len -= 3 * CRC32C_LANE;
+    }
+
+    while (len >= 8) {
+        std::memcpy(v, p, 8);
+        crc = __crc32cd(crc, v[0]);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+static bool has_hw() {
+    return getauxval(AT_HWCAP) & HWCAP_CRC32;
+}
+
+static const char *hw_name = "armv8";
+#endif
+
+typedef uint32_t (*crc_fn)(uint32_t, const uint8_t *, size_t);
+
+static crc_fn select_impl() {
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (has_hw()) return crc_hw;
+#endif
+    return crc_sw;
+}
+
+uint32_t CCrc32c::compute(const uint8_t *data, size_t len, uint32_t crc) {
+    static const crc_fn impl = select_impl();
+    return ~impl(~crc, data, len);
+}
+
+uint32_t CCrc32c::compute_portable(const uint8_t *data, size_t len, uint32_t crc) {
+    return ~crc_sw(~crc, data, len);
+}
+
+const char *CCrc32c::get_impl() {
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (has_hw()) return hw_name;
+#endif
+    return "slice-by-8";
+}
@@ -0,0 +1,162 @@
+/**
+ * CDeltaCodec.cpp - Delta and compression payload codec code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CDeltaCodec.hpp"
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+void CDeltaCodec::history::store(uint16_t frame_id, const uint8_t *data, size_t len) {
+    size_t slot = frame_id % DC_HISTORY;
+    payload[slot].assign(data, data + len);
+    id[slot] = frame_id;
+    valid[slot] = true;
+}
+
+const std::vector<uint8_t> *CDeltaCodec::history::find(uint16_t frame_id) const {
+    size_t slot = frame_id % DC_HISTORY;
+    if (!valid[slot] || id[slot] != frame_id) return nullptr;
+    return &payload[slot];
+}
+
+void CDeltaCodec::history::clear() {
+    for (bool &v : valid) v = false;
+}
+
+CDeltaCodec::CDeltaCodec(tx_callback tx, uint8_t caps) : _tx(std::move(tx)), _caps(caps) {}
+
+void CDeltaCodec::reset(uint8_t caps) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _caps = caps;
+    _tx_history.clear();
+    _rx_history.clear();
+    _has_base = false;
+    _since_key = 0;
+}
+
+bool CDeltaCodec::encode(const uint8_t *data, size_t len, std::vector<uint8_t> &frame) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_caps || len > UINT16_MAX) return false;
+
+    uint16_t id = _tx_next_id++;
+    const std::vector<uint8_t> *base = nullptr;
+
+    // only use a base the decoder can still have, and keyframe periodically anyway
+    if ((_caps & NET_CAP_DELTA) && _has_base && _since_key < DC_KEYFRAME_INTERVAL &&
+        (uint16_t) (id - _base_id) < DC_HISTORY) {
+        base = _tx_history.find(_base_id);
+    }
+
+    if (base) {
+        CCompressor::compress(data, len, base->data(), base->size(), _scratch);
+        if (_scratch.size() < len) {
+            frame.resize(DC_DELTA_HEADER_SIZE);
+            frame[0] = DC_TYPE_DELTA;
+            put16(&frame[1], id);
+            frame[3] = (uint8_t) (id - _base_id);
+            frame.insert(frame.end(), _scratch.begin(), _scratch.end());
+            _since_key++;
+            _tx_history.store(id, data, len);
+            _raw_bytes += len;
+            _encoded_bytes += frame.size();
+            return true;
+        }
+        // nothing in common with the base, a keyframe is smaller
+    }
+
+    uint8_t flags = 0;
+    if ((_caps & NET_CAP_LZ) && len >= DC_LZ_MIN) {
+        CCompressor::compress(data, len, nullptr, 0, _scratch);
+        if (_scratch.size() < len) flags |= DC_FLAG_LZ;
+    }
+    frame.resize(DC_KEY_HEADER_SIZE);
+    frame[0] = DC_TYPE_KEY;
+    frame[1] = flags;
+    put16(&frame[2], id);
+    if (flags & DC_FLAG_LZ) frame.insert(frame.end(), _scratch.begin(), _scratch.end());
+    else frame.insert(frame.end(), data, data + len);
+    _since_key = 0;
+    if (_caps & NET_CAP_DELTA) _tx_history.store(id, data, len);
+    _raw_bytes += len;
+    _encoded_bytes += frame.size();
+    return true;
+}
+
+bool CDeltaCodec::decode(const uint8_t *data, size_t len, std::vector<uint8_t> &out) {
+    std::vector<uint8_t> ack;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        uint16_t id;
+        bool key = data[0] == DC_TYPE_KEY;
+        if (key) {
+            if (len < DC_KEY_HEADER_SIZE) return false;
+            id = get16(data + 2);
+            const uint8_t *body = data + DC_KEY_HEADER_SIZE;
+            size_t body_len = len - DC_KEY_HEADER_SIZE;
+            if (data[1] & DC_FLAG_LZ) {
+                if (!CCompressor::decompress(body, body_len, nullptr, 0, UINT16_MAX, out)) return false;
+            } else {
+                out.assign(body, body + body_len);
+            }
+        } else {
+            if (len < DC_DELTA_HEADER_SIZE) return false;
+            id = get16(data + 1);
+            const std::vector<uint8_t> *base = _rx_history.find((uint16_t) (id - data[3]));
+            if (!base) return false;
+            if (!CCompressor::decompress(data + DC_DELTA_HEADER_SIZE, len - DC_DELTA_HEADER_SIZE,
+                                         base->data(), base->size(), UINT16_MAX, out)) {
+                return false;
+            }
+        }
+        if (!(_caps & NET_CAP_DELTA)) return true;
+
+        // ack sparsely, a base doesn't need to be the newest payload to make good deltas
+        _rx_history.store(id, out.data(), out.size());
+        if (!key && id % DC_ACK_INTERVAL) return true;
+        ack.resize(DC_ACK_SIZE);
+        ack[0] = DC_TYPE_ACK;
+        put16(&ack[1], id);
+    }
+    _tx(ack);
+    return true;
+}
+
+void CDeltaCodec::on_ack(const uint8_t *data, size_t len) {
+    if (len < DC_ACK_SIZE) return;
+    std::lock_guard<std::mutex> guard(_lock);
+    uint16_t id = get16(data + 1);
+
+    // acks can arrive out of order, keep the newest base
+    if (!_tx_history.find(id)) return;
+    if (_has_base && (int16_t) (id - _base_id) <= 0) return;
+    _has_base = true;
+    _base_id = id;
+}
+
+bool CDeltaCodec::is_codec_frame(uint8_t type) {
+    return type == DC_TYPE_KEY || type == DC_TYPE_DELTA || type == DC_TYPE_ACK;
+}
+
+uint8_t CDeltaCodec::get_caps() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _caps;
+}
+
+uint64_t CDeltaCodec::get_raw_bytes() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _raw_bytes;
+}
+
+uint64_t CDeltaCodec::get_encoded_bytes() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _encoded_bytes;
+}
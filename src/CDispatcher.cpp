@@ -0,0 +1,15 @@
+/**
+ * CDispatcher.cpp - Message dispatch by type id code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CDispatcher.hpp"
+
+void CDispatcher::on(uint8_t type, handler h) {
+    _handlers[type] = std::move(h);
+}
+
+void CDispatcher::on_frame(uint8_t type, handler h) {
+    _frames[type] = std::move(h);
+}
@@ -0,0 +1,71 @@
+/**
+ * CFrame.cpp - Timestamp prefix framing code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CFrame.hpp"
+
+bool CFrame::parse(const uint8_t *data, size_t len, frame_header &hdr) {
+    size_t i = 0;
+    hdr = frame_header();
+
+    // timestamp digits
+    while (i < len && data[i] >= '0' && data[i] <= '9') {
+        hdr.time_ms = hdr.time_ms * 10 + (data[i] - '0');
+        i++;
+    }
+    if (!i) return false;
+    hdr.time_len = i;
+
+    // optional :<seq>
+    if (i < len && data[i] == ':') {
+        size_t start = ++i;
+        while (i < len && data[i] >= '0' && data[i] <= '9') {
+            hdr.seq = hdr.seq * 10 + (data[i] - '0');
+            i++;
+        }
+        hdr.has_seq = i > start;
+    }
+
+    // optional library frame mark
+    if (i < len && data[i] == FRAME_CTRL_MARK) {
+        hdr.control = true;
+        i++;
+    }
+
+    // optional #<crc>, always FRAME_CRC_DIGITS hex digits
+    if (i < len && data[i] == FRAME_CRC_MARK) {
+        hdr.crc_start = i++;
+        if (len - i < FRAME_CRC_DIGITS) return false;
+        for (size_t end = i + FRAME_CRC_DIGITS; i < end; i++) {
+            uint8_t c = data[i];
+            uint32_t digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else return false;
+            hdr.crc = (hdr.crc << 4) | digit;
+        }
+        hdr.has_crc = true;
+    }
+
+    // single space, then a non-empty body
+    if (i >= len || data[i] != ' ') return false;
+    hdr.body_start = i + 1;
+    return hdr.body_start < len;
+}
+
+bool CFrame::check_crc(const uint8_t *data, size_t len, const frame_header &hdr) {
+    if (!hdr.has_crc) return true;
+    uint32_t crc = CCrc32c::compute(data, hdr.crc_start);
+    return CCrc32c::compute(data + hdr.body_start, len - hdr.body_start, crc) == hdr.crc;
+}
+
+void CFrame::append_crc(std::string &prefix, const uint8_t *head, size_t head_len, const uint8_t *body, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    uint32_t crc = CCrc32c::compute(reinterpret_cast<const uint8_t *>(prefix.data()), prefix.size());
+    if (head_len) crc = CCrc32c::compute(head, head_len, crc);
+    crc = CCrc32c::compute(body, len, crc);
+    prefix += FRAME_CRC_MARK;
+    for (int shift = 28; shift >= 0; shift -= 4) prefix += hex[(crc >> shift) & 0xF];
+}
@@ -0,0 +1,109 @@
+/**
+ * CImpairment.cpp - Seeded network impairment model code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CImpairment.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr double two_pi = 6.283185307179586;
+
+// uniform in [0, 1) from the generator's raw output, std distributions differ between standard libraries
+static double uniform(std::mt19937_64 &rng) {
+    return (double) (rng() >> 11) * 0x1.0p-53;
+}
+
+CImpairment::CImpairment(const impairment_config &config) {
+    configure(config);
+}
+
+void CImpairment::configure(const impairment_config &config) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _config = config;
+    _rng.seed(config.seed);
+    _bad = false;
+    _link_free_us = 0;
+    _last_delivery_us = 0;
+}
+
+int64_t CImpairment::draw_delay() {
+    double delay = (double) _config.delay_us;
+    auto jitter = (double) _config.jitter_us;
+    if (jitter > 0) {
+        switch (_config.dist) {
+            case impairment_config::DELAY_UNIFORM:
+                delay += jitter * (2 * uniform(_rng) - 1);
+                break;
+            case impairment_config::DELAY_NORMAL: {
+                // Box-Muller, 1 - u keeps the log away from 0
+                double u1 = 1 - uniform(_rng);
+                double u2 = uniform(_rng);
+                delay += jitter * std::sqrt(-2 * std::log(u1)) * std::cos(two_pi * u2);
+                break;
+            }
+            case impairment_config::DELAY_PARETO:
+                // scaled so the extra delay averages jitter
+                delay += jitter * (IMP_PARETO_SHAPE - 1) * (std::pow(1 - uniform(_rng), -1 / IMP_PARETO_SHAPE) - 1);
+                break;
+        }
+    }
+    return std::max<int64_t>(std::llround(delay), 0);
+}
+
+size_t CImpairment::schedule(size_t len, int64_t now_us, int64_t out[2]) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stats.packets++;
+
+    // the Gilbert-Elliott chain steps once per packet, each state has its own loss rate
+    double loss = _config.loss;
+    if (_config.burst_enter > 0) {
+        double u = uniform(_rng);
+        _bad = _bad ? u >= _config.burst_exit : u < _config.burst_enter;
+        if (_bad) loss = _config.burst_loss;
+    }
+    if (loss > 0 && uniform(_rng) < loss) {
+        _stats.lost++;
+        if (_bad) _stats.burst_lost++;
+        return 0;
+    }
+
+    // bottleneck, a packet leaves once everything queued before it has been serialized
+    int64_t depart = now_us;
+    if (_config.rate_bps) {
+        int64_t start = std::max(now_us, _link_free_us);
+        auto backlog = (size_t) ((double) (start - now_us) * (double) _config.rate_bps / 8e6);
+        if (backlog + len > _config.queue_bytes) {
+            _stats.queue_dropped++;
+            return 0;
+        }
+        _link_free_us = start + (int64_t) std::ceil((double) len * 8e6 / (double) _config.rate_bps);
+        depart = _link_free_us;
+    }
+
+    int64_t at = depart + draw_delay();
+    if (_config.reorder > 0 && uniform(_rng) < _config.reorder) {
+        // later packets don't wait for this one, so they overtake it
+        at += _config.reorder_us;
+        _stats.reordered++;
+    } else {
+        if (!_config.jitter_reorders) at = std::max(at, _last_delivery_us);
+        _last_delivery_us = std::max(_last_delivery_us, at);
+    }
+
+    out[0] = at;
+    size_t n = 1;
+    if (_config.duplicate > 0 && uniform(_rng) < _config.duplicate) {
+        out[n++] = at;
+        _stats.duplicated++;
+    }
+    _stats.delivered += n;
+    return n;
+}
+
+impairment_stats CImpairment::get_stats() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _stats;
+}
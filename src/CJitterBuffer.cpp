@@ -0,0 +1,140 @@
+/**
+ * CJitterBuffer.cpp - Playout jitter buffer code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CJitterBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CJitterBuffer::CJitterBuffer(size_t capacity, int64_t min_delay_ms, int64_t max_delay_ms)
+        : _min_margin(min_delay_ms), _max_margin(std::max(min_delay_ms, max_delay_ms)) {
+    // power of two so seq % capacity stays contiguous when the sequence number wraps
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    _slots.resize(size);
+}
+
+void CJitterBuffer::restart(uint32_t seq) {
+    for (slot &s : _slots) s.valid = false;
+    _count = 0;
+    _next = seq;
+}
+
+int64_t CJitterBuffer::due(int64_t time_ms) const {
+    double margin = std::min(std::max((double) JB_JITTER_MULT * _jitter, (double) _min_margin), (double) _max_margin);
+    return time_ms + std::llround(_transit + margin);
+}
+
+CJitterBuffer::slot *CJitterBuffer::front() {
+    if (!_count) return nullptr;
+    size_t mask = _slots.size() - 1;
+    for (size_t i = 0; i < _slots.size(); i++) {
+        slot &s = _slots[(_next + i) & mask];
+        if (s.valid) return &s;
+    }
+    return nullptr;
+}
+
+bool CJitterBuffer::push(uint32_t seq, int64_t time_ms, const uint8_t *data, size_t len, int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto transit = (double) (now_ms - time_ms);
+    if (!_started) {
+        _started = true;
+        _transit = transit;
+        _jitter = 0;
+        restart(seq);
+    } else {
+        auto delta = (int32_t) (seq - _next);
+        if (delta > JB_MAX_DROPOUT || delta < -JB_MAX_MISORDER) {
+            restart(seq);
+            _stats.restarts++;
+        }
+    }
+
+    // judge lateness by the schedule in force, then let this sample move it
+    int64_t deadline = due(time_ms);
+    _jitter += (std::fabs(transit - _transit) - _jitter) / 16.0;
+    _transit += (transit - _transit) / JB_TRANSIT_GAIN;
+
+    auto delta = (int32_t) (seq - _next);
+    if (delta < 0 || now_ms > deadline) {
+        _stats.late++;
+        return false;
+    }
+
+    // beyond the window, play past whatever doesn't fit any more
+    if ((size_t) delta >= _slots.size()) {
+        uint32_t first = seq - (uint32_t) _slots.size() + 1;
+        while (_next != first && _count) {
+            slot &old = _slots[_next & (_slots.size() - 1)];
+            if (old.valid) {
+                old.valid = false;
+                _count--;
+                _stats.overflowed++;
+            } else {
+                _stats.skipped++;
+            }
+            _next++;
+        }
+        _stats.skipped += (uint32_t) (first - _next);
+        _next = first;
+    }
+
+    slot &s = _slots[seq & (_slots.size() - 1)];
+    if (s.valid) {
+        _stats.duplicated++;
+        return false;
+    }
+    s.data.assign(data, data + len);
+    s.seq = seq;
+    s.time_ms = time_ms;
+    s.valid = true;
+    _count++;
+    _stats.pushed++;
+    return true;
+}
+
+bool CJitterBuffer::pop(std::vector<uint8_t> &out, int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(_lock);
+    slot *s = front();
+    if (!s || now_ms < due(s->time_ms)) return false;
+
+    // anything still missing before it would be late now
+    _stats.skipped += (uint32_t) (s->seq - _next);
+    _next = s->seq + 1;
+
+    // swap so both sides keep their storage
+    out.swap(s->data);
+    s->valid = false;
+    _count--;
+    _stats.released++;
+    return true;
+}
+
+int64_t CJitterBuffer::time_to_next(int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(_lock);
+    slot *s = front();
+    if (!s) return -1;
+    return std::max<int64_t>(due(s->time_ms) - now_ms, 0);
+}
+
+void CJitterBuffer::reset() {
+    std::lock_guard<std::mutex> lock(_lock);
+    restart(0);
+    _started = false;
+    _transit = 0;
+    _jitter = 0;
+}
+
+jitter_stats CJitterBuffer::get_stats() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    jitter_stats s = _stats;
+    s.depth = _count;
+    s.transit_ms = _transit;
+    s.jitter_ms = _jitter;
+    s.margin_ms = std::min(std::max((double) JB_JITTER_MULT * _jitter, (double) _min_margin), (double) _max_margin);
+    return s;
+}
@@ -0,0 +1,220 @@
+/**
+ * CMetrics.cpp - Runtime metrics registry code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CMetrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <spdlog/spdlog.h>
+
+CMetrics &CMetrics::global() {
+    static CMetrics metrics;
+    return metrics;
+}
+
+size_t CMetrics::thread_shard() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARDS;
+    return shard;
+}
+
+int CMetrics::add(const std::string &name, const std::string &help, const std::string &labels, metric_type type) {
+    std::lock_guard<std::mutex> guard(_register_lock);
+
+    // reuse a slot freed by a removed endpoint before taking a new one
+    int count = _count.load(std::memory_order_relaxed);
+    int id = 0;
+    while (id < count && _entries[id]->live) id++;
+    if (id >= METRICS_MAX) {
+        spdlog::warn("Metrics registry full, not registering " + name);
+        return -1;
+    }
+
+    // entries stay allocated, a stale id from a removed endpoint still points at valid memory
+    if (!_entries[id]) _entries[id] = std::make_unique<entry>();
+    entry &e = *_entries[id];
+    e.name = name;
+    e.help = help;
+    e.labels = labels;
+    e.type = type;
+    for (auto &sh : e.shards) sh.value.store(0, std::memory_order_relaxed);
+    e.gauge.store(0, std::memory_order_relaxed);
+    e.live = true;
+    if (id == count) _count.store(id + 1, std::memory_order_relaxed);
+    return id;
+}
+
+void CMetrics::remove(int id) {
+    if (id < 0) return;
+    _entries[id]->live = false;
+}
+
+int CMetrics::add_counter(const std::string &name, const std::string &help, const std::string &labels) {
+    return add(name, help, labels, COUNTER);
+}
+
+int CMetrics::add_gauge(const std::string &name, const std::string &help, const std::string &labels) {
+    return add(name, help, labels, GAUGE);
+}
+
+net_metrics CMetrics::add_endpoint(const std::string &endpoint) {
+    std::string labels = "endpoint=\"" + endpoint + "\",instance=\"" + std::to_string(_instances.fetch_add(1)) + "\"";
+    net_metrics m;
+    m.rx_packets = add_counter("vikanet_rx_packets_total", "Packets received", labels);
+    m.rx_bytes = add_counter("vikanet_rx_bytes_total", "Bytes received", labels);
+    m.tx_packets = add_counter("vikanet_tx_packets_total", "Packets sent", labels);
+    m.tx_bytes = add_counter("vikanet_tx_bytes_total", "Bytes sent", labels);
+    m.rx_eagain = add_counter("vikanet_rx_eagain_total", "Nonblocking receives that found no data", labels);
+    m.rx_malformed = add_counter("vikanet_rx_malformed_total", "Malformed packets received", labels);
+    m.rx_bad_crc = add_counter("vikanet_rx_bad_crc_total", "Packets received with a bad checksum", labels);
+    m.tx_errors = add_counter("vikanet_tx_errors_total", "Failed sends", labels);
+    m.queue_depth = add_gauge("vikanet_queue_depth", "Items waiting in internal queue", labels);
+    m.in_flight = add_gauge("vikanet_reliable_in_flight", "Reliable frames awaiting acknowledgement", labels);
+    return m;
+}
+
+void CMetrics::remove_endpoint(net_metrics &metrics) {
+    {
+        std::lock_guard<std::mutex> guard(_register_lock);
+        for (int id : {metrics.rx_packets, metrics.rx_bytes, metrics.tx_packets, metrics.tx_bytes, metrics.rx_eagain,
+                       metrics.rx_malformed, metrics.rx_bad_crc, metrics.tx_errors, metrics.queue_depth, metrics.in_flight}) {
+            remove(id);
+        }
+    }
+    metrics = net_metrics();
+}
+
+std::vector<CMetrics::sample> CMetrics::snapshot() const {
+    std::vector<sample> out;
+    std::lock_guard<std::mutex> guard(_register_lock);
+    int count = _count.load(std::memory_order_relaxed);
+    out.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const entry &e = *_entries[i];
+        if (!e.live) continue;
+        sample s;
+        s.name = e.name;
+        s.help = e.help;
+        s.labels = e.labels;
+        s.type = e.type;
+        if (e.type == COUNTER) {
+            uint64_t sum = 0;
+            for (const auto &sh : e.shards) sum += sh.value.load(std::memory_order_relaxed);
+            s.value = (int64_t) sum;
+        } else {
+            s.value = e.gauge.load(std::memory_order_relaxed);
+        }
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+std::string CMetrics::to_prometheus() const {
+    // families must be contiguous, registration order interleaves them across endpoints
+    std::vector<sample> samples = snapshot();
+    std::stable_sort(samples.begin(), samples.end(), [](const sample &a, const sample &b) {
+        return a.name < b.name;
+    });
+
+    std::stringstream ss;
+    std::string last_name;
+    for (const auto &s : samples) {
+        // HELP/TYPE once per metric family
+        if (s.name != last_name) {
+            ss << "# HELP " << s.name << " " << s.help << "\n";
+            ss << "# TYPE " << s.name << (s.type == COUNTER ? " counter" : " gauge") << "\n";
+            last_name = s.name;
+        }
+        ss << s.name;
+        if (!s.labels.empty()) ss << "{" << s.labels << "}";
+        ss << " " << s.value << "\n";
+    }
+    return ss.str();
+}
+
+std::string CMetrics::to_json() const {
+    std::stringstream ss;
+    ss << "[";
+    bool first = true;
+    for (const auto &s : snapshot()) {
+        if (!first) ss << ",";
+        first = false;
+
+        // labels are already key="value" pairs, quote the keys to make them JSON
+        std::string labels;
+        for (size_t i = 0; i < s.labels.size(); i++) {
+            size_t eq = s.labels.find('=', i);
+            if (eq == std::string::npos) break;
+            size_t end = s.labels.find('"', s.labels.find('"', eq) + 1);
+            if (!labels.empty()) labels += ",";
+            labels += "\"" + s.labels.substr(i, eq - i) + "\":" + s.labels.substr(eq + 1, end - eq);
+            i = end + 1;
+        }
+
+        ss << "{\"name\":\"" << s.name << "\",\"type\":\"" << (s.type == COUNTER ? "counter" : "gauge")
+           << "\",\"labels\":{" << labels << "},\"value\":" << s.value << "}";
+    }
+    ss << "]\n";
+    return ss.str();
+}
+
+bool CMetrics::export_file(const std::string &path, bool json) const {
+    // write then rename so a scraper never sees a partial file
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            spdlog::error("Error opening metrics file " + tmp);
+            return false;
+        }
+        out << (json ? to_json() : to_prometheus());
+        if (!out) return false;
+    }
+    if (std::rename(tmp.c_str(), path.c_str())) {
+        spdlog::error("Error replacing metrics file " + path);
+        return false;
+    }
+    return true;
+}
+
+bool CMetrics::export_socket(const std::string &path, bool json) const {
+#ifdef WIN32
+    spdlog::error("Metrics socket export not supported on Windows");
+    return false;
+#else
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        spdlog::error("Metrics socket path too long");
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        spdlog::error("Error opening metrics socket");
+        return false;
+    }
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    std::string body = json ? to_json() : to_prometheus();
+    size_t sent = 0;
+    while (sent < body.size()) {
+        ssize_t n = send(fd, body.data() + sent, body.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += (size_t) n;
+    }
+    close(fd);
+    return sent == body.size();
+#endif
+}
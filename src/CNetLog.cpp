@@ -0,0 +1,95 @@
+/**
+ * CNetLog.cpp - Hot path logging helpers code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CNetLog.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// limiters live in function statics all over the library, this outlives every one of them
+static std::mutex &limiters_lock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::vector<CLogLimiter *> &limiters() {
+    static std::vector<CLogLimiter *> list;
+    return list;
+}
+
+static std::atomic<int64_t> next_flush_ms{0};
+
+CLogLimiter::CLogLimiter(int64_t interval_ms) : _interval_ms(interval_ms) {
+    CNetLog::register_limiter(this, true);
+}
+
+CLogLimiter::~CLogLimiter() {
+    CNetLog::register_limiter(this, false);
+}
+
+void CLogLimiter::log(spdlog::level::level_enum level, const std::string &msg, uint64_t suppressed) {
+    {
+        std::lock_guard<std::mutex> guard(_last_lock);
+        _last_level = level;
+        _last = msg;
+    }
+    if (suppressed) {
+        spdlog::log(level, msg + " (" + std::to_string(suppressed) + " suppressed)");
+    } else {
+        spdlog::log(level, msg);
+    }
+}
+
+void CLogLimiter::flush(bool force) {
+    if (!_suppressed.load(std::memory_order_relaxed)) return;
+
+    // inside the interval the next message through reports the count itself, take the slot like allow() does
+    int64_t now = now_ms();
+    int64_t next = _next_ms.load(std::memory_order_relaxed);
+    if (!force && (now < next || !_next_ms.compare_exchange_strong(next, now + _interval_ms, std::memory_order_relaxed))) return;
+
+    uint64_t suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    if (!suppressed) return;
+    std::lock_guard<std::mutex> guard(_last_lock);
+    spdlog::log(_last_level, _last + " (" + std::to_string(suppressed) + " suppressed)");
+}
+
+void CNetLog::init_async(size_t queue_size) {
+    // the thread pool and the logger can't be replaced while the old ones may still be in use
+    if (spdlog::get("vika-net")) return;
+    spdlog::init_thread_pool(queue_size, 1);
+    auto logger = spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>("vika-net");
+    logger->set_level(spdlog::default_logger()->level());
+    spdlog::set_default_logger(logger);
+}
+
+void CNetLog::flush_suppressed(bool force) {
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = next_flush_ms.load(std::memory_order_relaxed);
+    if (!force && (now < next || !next_flush_ms.compare_exchange_strong(next, now + NET_LOG_INTERVAL_MS, std::memory_order_relaxed))) return;
+
+    std::lock_guard<std::mutex> guard(limiters_lock());
+    for (CLogLimiter *limiter : limiters()) limiter->flush(force);
+}
+
+void CNetLog::shutdown() {
+    flush_suppressed(true);
+    spdlog::shutdown();
+}
+
+void CNetLog::register_limiter(CLogLimiter *limiter, bool add) {
+    std::lock_guard<std::mutex> guard(limiters_lock());
+    auto &list = limiters();
+    if (add) {
+        list.push_back(limiter);
+    } else {
+        list.erase(std::remove(list.begin(), list.end(), limiter), list.end());
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * CPacer.cpp - Token bucket send pacer code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CPacer.hpp"
+
+#include <algorithm>
+
+CPacer::CPacer(uint64_t rate, uint64_t burst) {
+    set_rate(rate, burst);
+}
+
+void CPacer::set_rate(uint64_t rate, uint64_t burst) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _rate = (double) rate;
+    _burst = (double) burst;
+    _tokens = _burst;
+    _last = std::chrono::steady_clock::now();
+}
+
+void CPacer::refill(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - _last).count();
+    _tokens = std::min(_burst, _tokens + elapsed * _rate);
+    _last = now;
+}
+
+std::chrono::steady_clock::time_point CPacer::reserve(size_t bytes) {
+    std::lock_guard<std::mutex> guard(_lock);
+    auto now = std::chrono::steady_clock::now();
+    if (_rate <= 0) return now;
+
+    refill(now);
+    _tokens -= (double) bytes;
+    if (_tokens >= 0) return now;
+
+    // in debt, send once the deficit has been paid back
+    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(-_tokens / _rate));
+}
+
+void CPacer::wait(size_t bytes) {
+    std::this_thread::sleep_until(reserve(bytes));
+}
+
+bool CPacer::is_enabled() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _rate > 0;
+}
+
+uint64_t CPacer::get_rate() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return (uint64_t) _rate;
+}
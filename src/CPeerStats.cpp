@@ -0,0 +1,156 @@
+/**
+ * CPeerStats.cpp - Per-peer loss, reorder and jitter statistics code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CPeerStats.hpp"
+
+#include <cstdlib>
+#include <thread>
+
+void CPeerStats::reset() {
+    _started = false;
+    _base_seq = 0;
+    _max_seq = 0;
+    _window = 0;
+    _received_since_base = 0;
+    _lost_carry = 0;
+    _last_transit_ms = 0;
+    _jitter = 0;
+    _received.store(0, std::memory_order_relaxed);
+    _lost.store(0, std::memory_order_relaxed);
+    _reordered.store(0, std::memory_order_relaxed);
+    _duplicated.store(0, std::memory_order_relaxed);
+    _highest_seq.store(0, std::memory_order_relaxed);
+    _jitter_ms.store(0, std::memory_order_relaxed);
+}
+
+void CPeerStats::restart(uint32_t seq) {
+    // keep losses counted so far, only the sequence base moves
+    _lost_carry = _lost.load(std::memory_order_relaxed);
+    _base_seq = seq;
+    _max_seq = seq;
+    _window = 1;
+    _received_since_base = 1;
+}
+
+void CPeerStats::on_rx(uint32_t seq, int64_t sent_ms, int64_t arrival_ms) {
+    // jitter, RFC 3550 section 6.4.1
+    int64_t transit = arrival_ms - sent_ms;
+    if (_started) {
+        double d = (double) std::llabs(transit - _last_transit_ms);
+        _jitter += (d - _jitter) / 16.0;
+        _jitter_ms.store(_jitter, std::memory_order_relaxed);
+    }
+    _last_transit_ms = transit;
+
+    if (!_started) {
+        _started = true;
+        restart(seq);
+    } else {
+        auto delta = (int32_t) (seq - _max_seq);
+        if (delta > STATS_MAX_DROPOUT || delta < -STATS_MAX_MISORDER) {
+            restart(seq);
+        } else if (delta > 0) {
+            // slide window forward
+            _window = delta >= STATS_WINDOW ? 0 : _window << delta;
+            _window |= 1;
+            _max_seq = seq;
+            _received_since_base++;
+        } else if (-delta >= STATS_WINDOW) {
+            // too old to tell if it was seen before, call it reordered
+            _reordered.fetch_add(1, std::memory_order_relaxed);
+        } else if (_window & ((uint64_t) 1 << -delta)) {
+            _duplicated.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            _window |= (uint64_t) 1 << -delta;
+            _received_since_base++;
+            _reordered.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // expected minus received, same as RFC 3550 cumulative loss
+    uint64_t expected = (uint64_t) (uint32_t) (_max_seq - _base_seq) + 1;
+    uint64_t lost = expected > _received_since_base ? expected - _received_since_base : 0;
+    _received.fetch_add(1, std::memory_order_relaxed);
+    _lost.store(_lost_carry + lost, std::memory_order_relaxed);
+    _highest_seq.store(_max_seq, std::memory_order_relaxed);
+}
+
+peer_stats CPeerStats::snapshot() const {
+    peer_stats s;
+    s.received = _received.load(std::memory_order_relaxed);
+    s.lost = _lost.load(std::memory_order_relaxed);
+    s.reordered = _reordered.load(std::memory_order_relaxed);
+    s.duplicated = _duplicated.load(std::memory_order_relaxed);
+    s.highest_seq = _highest_seq.load(std::memory_order_relaxed);
+    s.jitter_ms = _jitter_ms.load(std::memory_order_relaxed);
+    return s;
+}
+
+CPeerStatsTable::slot *CPeerStatsTable::find(uint64_t key, bool claim) {
+    // linear probing from a multiplicative hash of the key
+    size_t start = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) % STATS_MAX_PEERS;
+    for (;;) {
+        slot *free = nullptr;
+        for (size_t i = 0; i < STATS_MAX_PEERS; i++) {
+            slot &s = _slots[(start + i) % STATS_MAX_PEERS];
+            uint64_t current = s.key.load(std::memory_order_acquire);
+
+            // a slot being claimed may be for this key, wait for it
+            while (current == STATS_KEY_CLAIMING) {
+                std::this_thread::yield();
+                current = s.key.load(std::memory_order_acquire);
+            }
+            if (current == key) return &s;
+
+            // the peer may still be further along past a released slot, never past an unused one
+            if (current == STATS_KEY_FREED || current == 0) {
+                if (!free) free = &s;
+                if (current == 0) break;
+            }
+        }
+        if (!claim || !free) return nullptr;
+
+        // mark the slot so nobody uses it before it is cleared, start over if another thread got there first
+        uint64_t expected = free->key.load(std::memory_order_acquire);
+        if ((expected != 0 && expected != STATS_KEY_FREED) ||
+            !free->key.compare_exchange_strong(expected, STATS_KEY_CLAIMING, std::memory_order_acq_rel)) {
+            continue;
+        }
+        free->stats.reset();
+        free->tx_seq.store(0, std::memory_order_relaxed);
+        free->key.store(key, std::memory_order_release);
+        return free;
+    }
+}
+
+CPeerStats *CPeerStatsTable::get(uint64_t key) {
+    slot *s = find(key, true);
+    return s ? &s->stats : nullptr;
+}
+
+bool CPeerStatsTable::next_tx_seq(uint64_t key, uint32_t &seq) {
+    slot *s = find(key, true);
+    if (!s) return false;
+    seq = s->tx_seq.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CPeerStatsTable::release(uint64_t key) {
+    slot *s = find(key, false);
+    if (s) s->key.store(STATS_KEY_FREED, std::memory_order_release);
+}
+
+void CPeerStatsTable::snapshot(std::vector<uint64_t> &keys, std::vector<peer_stats> &stats) const {
+    keys.clear();
+    stats.clear();
+    for (const auto &s : _slots) {
+        uint64_t key = s.key.load(std::memory_order_acquire);
+        if (!key || key == STATS_KEY_FREED || key == STATS_KEY_CLAIMING) continue;
+        keys.push_back(key);
+        stats.push_back(s.stats.snapshot());
+    }
+}
@@ -0,0 +1,275 @@
+/**
+ * CReliableChannel.cpp - Selective-ACK reliable delivery channel code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CReliableChannel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static void put_u32(std::vector<uint8_t> &buf, uint32_t v) {
+    for (int i = 0; i < 4; i++) buf.push_back((uint8_t) (v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t> &buf, uint64_t v) {
+    for (int i = 0; i < 8; i++) buf.push_back((uint8_t) (v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t) get_u32(p) | ((uint64_t) get_u32(p + 4) << 32);
+}
+
+static void set_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t) (v >> (8 * i));
+}
+
+// serial number arithmetic, so sequence numbers can wrap
+static int32_t seq_diff(uint32_t a, uint32_t b) {
+    return (int32_t) (a - b);
+}
+
+CReliableChannel::CReliableChannel(tx_callback tx, size_t window) : _tx(std::move(tx)) {
+    _window = std::max<size_t>(1, std::min<size_t>(window, RC_WINDOW_MAX));
+    _tx_epoch = new_epoch();
+}
+
+uint32_t CReliableChannel::new_epoch() {
+    static std::mutex lock;
+    static std::mt19937 rng(std::random_device{}());
+    std::lock_guard<std::mutex> guard(lock);
+    uint32_t epoch;
+    do {
+        epoch = rng();
+    } while (!epoch);
+    return epoch;
+}
+
+bool CReliableChannel::is_reliable_frame(uint8_t type) {
+    return type == RC_TYPE_DATA || type == RC_TYPE_SACK;
+}
+
+bool CReliableChannel::send(const std::vector<uint8_t> &payload) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_in_flight.size() >= _window) return false;
+
+    in_flight f;
+    f.seq = _tx_next_seq++;
+    f.frame.reserve(RC_HEADER_SIZE + payload.size());
+    f.frame.push_back(RC_TYPE_DATA);
+    put_u32(f.frame, _tx_epoch);
+    put_u32(f.frame, f.seq);
+    f.frame.insert(f.frame.end(), payload.begin(), payload.end());
+    f.sent = std::chrono::steady_clock::now();
+    _in_flight.push_back(std::move(f));
+
+    // a frame that fails to go out is still in flight, the retransmit timer will pick it up
+    return _tx(_in_flight.back().frame);
+}
+
+bool CReliableChannel::on_rx(const uint8_t *data, size_t len) {
+    if (!len || !is_reliable_frame(data[0])) return false;
+    std::lock_guard<std::mutex> guard(_lock);
+
+    if (data[0] == RC_TYPE_SACK) {
+        if (len < RC_SACK_SIZE) {
+            NET_LOG_LIMITED(spdlog::level::warn, "Short SACK frame received");
+            return true;
+        }
+        handle_sack(data);
+        return true;
+    }
+
+    if (len < RC_HEADER_SIZE) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Short reliable frame received");
+        return true;
+    }
+
+    uint32_t epoch = get_u32(data + 1);
+    uint32_t seq = get_u32(data + 5);
+
+    // a new epoch is only followed from its first frame, otherwise earlier frames may be missing
+    if (epoch != _rx_epoch) {
+        if (epoch == _rx_refused || seq != 0) {
+            _rx_refused = epoch;
+            send_reset(epoch);
+            return true;
+        }
+        _rx_epoch = epoch;
+        _rx_next_seq = 0;
+        _rx_ooo.clear();
+    }
+    int32_t ahead = seq_diff(seq, _rx_next_seq);
+
+    // only accept frames inside the receive window, anything behind is a duplicate
+    if (ahead == 0) {
+        _rx_ready.emplace(data + RC_HEADER_SIZE, data + len);
+        _rx_next_seq++;
+
+        // drain anything that was waiting on this hole
+        for (auto it = _rx_ooo.find(_rx_next_seq); it != _rx_ooo.end(); it = _rx_ooo.find(_rx_next_seq)) {
+            _rx_ready.emplace(std::move(it->second));
+            _rx_ooo.erase(it);
+            _rx_next_seq++;
+        }
+    } else if (ahead > 0 && ahead <= RC_WINDOW_MAX) {
+        _rx_ooo.emplace(seq, std::vector<uint8_t>(data + RC_HEADER_SIZE, data + len));
+    }
+
+    // always ack, the previous SACK may have been lost
+    send_sack();
+    return true;
+}
+
+bool CReliableChannel::recv(std::vector<uint8_t> &out) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_rx_ready.empty()) return false;
+    out = std::move(_rx_ready.front());
+    _rx_ready.pop();
+    return true;
+}
+
+void CReliableChannel::service() {
+    std::lock_guard<std::mutex> guard(_lock);
+    auto now = std::chrono::steady_clock::now();
+    bool backed_off = false;
+
+    for (auto &f : _in_flight) {
+        if (f.sacked) continue;
+        bool timed_out = std::chrono::duration_cast<std::chrono::milliseconds>(now - f.sent).count() >= _rto_ms;
+        bool fast = f.dup_sacks >= RC_DUP_THRESHOLD;
+        if (!timed_out && !fast) continue;
+
+        // back off once per timeout round, not once per frame
+        if (timed_out && !backed_off) {
+            _rto_ms = std::min(_rto_ms * 2, RC_RTO_MAX);
+            backed_off = true;
+        }
+
+        f.sent = now;
+        f.retransmits++;
+        f.dup_sacks = 0;
+        _retransmit_count++;
+        _tx(f.frame);
+    }
+}
+
+void CReliableChannel::send_sack() {
+    uint64_t bitmap = 0;
+    for (const auto &p : _rx_ooo) {
+        int32_t offset = seq_diff(p.first, _rx_next_seq) - 1;
+        if (offset >= 0 && offset < 64) bitmap |= (uint64_t) 1 << offset;
+    }
+
+    std::vector<uint8_t> frame;
+    frame.reserve(RC_SACK_SIZE);
+    frame.push_back(RC_TYPE_SACK);
+    put_u32(frame, _rx_epoch);
+    put_u32(frame, _rx_next_seq);
+    put_u64(frame, bitmap);
+    frame.push_back(0);
+    _tx(frame);
+}
+
+void CReliableChannel::send_reset(uint32_t epoch) {
+    std::vector<uint8_t> frame;
+    frame.reserve(RC_SACK_SIZE);
+    frame.push_back(RC_TYPE_SACK);
+    put_u32(frame, epoch);
+    put_u32(frame, 0);
+    put_u64(frame, 0);
+    frame.push_back(RC_SACK_RESET);
+    _tx(frame);
+}
+
+void CReliableChannel::restart_epoch() {
+    _tx_epoch = new_epoch();
+    _tx_next_seq = 0;
+    auto now = std::chrono::steady_clock::now();
+    for (auto &f : _in_flight) {
+        f.seq = _tx_next_seq++;
+        set_u32(f.frame.data() + 1, _tx_epoch);
+        set_u32(f.frame.data() + 5, f.seq);
+        f.sent = now;
+        f.retransmits++;
+        f.dup_sacks = 0;
+        f.sacked = false;
+        _retransmit_count++;
+        _tx(f.frame);
+    }
+}
+
+void CReliableChannel::handle_sack(const uint8_t *data) {
+    // SACKs for an earlier epoch are stale
+    if (get_u32(data + 1) != _tx_epoch) return;
+    if (data[17] & RC_SACK_RESET) {
+        spdlog::info("Reliable channel peer lost its state, renumbering " + std::to_string(_in_flight.size()) + " frames");
+        restart_epoch();
+        return;
+    }
+
+    uint32_t cum_ack = get_u32(data + 5);
+    uint64_t bitmap = get_u64(data + 9);
+    auto now = std::chrono::steady_clock::now();
+
+    // highest sequence number the receiver has reported, used for fast retransmit
+    uint32_t highest = cum_ack - 1;
+    for (int i = 63; i >= 0; i--) {
+        if (bitmap & ((uint64_t) 1 << i)) {
+            highest = cum_ack + 1 + i;
+            break;
+        }
+    }
+
+    for (auto &f : _in_flight) {
+        int32_t offset = seq_diff(f.seq, cum_ack);
+        bool acked = offset < 0 || (offset > 0 && offset <= 64 && (bitmap & ((uint64_t) 1 << (offset - 1))));
+
+        if (acked && !f.sacked) {
+            // Karn's algorithm, retransmitted frames give ambiguous samples
+            if (!f.retransmits) {
+                update_rtt((double) std::chrono::duration_cast<std::chrono::microseconds>(now - f.sent).count() / 1000.0);
+            }
+            f.sacked = true;
+        } else if (!acked && seq_diff(highest, f.seq) > 0) {
+            f.dup_sacks++;
+        }
+    }
+
+    // release everything covered by the cumulative ack
+    while (!_in_flight.empty() && seq_diff(_in_flight.front().seq, cum_ack) < 0) {
+        _in_flight.pop_front();
+    }
+}
+
+void CReliableChannel::update_rtt(double sample_ms) {
+    if (!_rtt_valid) {
+        _srtt_ms = sample_ms;
+        _rttvar_ms = sample_ms / 2;
+        _rtt_valid = true;
+    } else {
+        _rttvar_ms = 0.75 * _rttvar_ms + 0.25 * std::abs(_srtt_ms - sample_ms);
+        _srtt_ms = 0.875 * _srtt_ms + 0.125 * sample_ms;
+    }
+    _rto_ms = std::max(RC_RTO_MIN, std::min(RC_RTO_MAX, (int) (_srtt_ms + std::max(1.0, 4 * _rttvar_ms))));
+}
+
+size_t CReliableChannel::get_in_flight() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _in_flight.size();
+}
+
+int CReliableChannel::get_rto_ms() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _rto_ms;
+}
+
+uint64_t CReliableChannel::get_retransmit_count() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _retransmit_count;
+}
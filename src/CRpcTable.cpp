@@ -0,0 +1,106 @@
+/**
+ * CRpcTable.cpp - In-flight RPC call table code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CRpcTable.hpp"
+
+CRpcTable::CRpcTable() : _entries(CAPACITY) {}
+
+size_t CRpcTable::home(uint32_t id) {
+    // fibonacci hashing spreads sequential ids across the table
+    return (size_t) ((id * 2654435769u) >> 16) & (CAPACITY - 1);
+}
+
+long CRpcTable::find(uint32_t id) const {
+    for (size_t i = home(id), n = 0; n < CAPACITY; i = (i + 1) & (CAPACITY - 1), n++) {
+        if (!_entries[i].used) return -1;
+        if (_entries[i].id == id) return (long) i;
+    }
+    return -1;
+}
+
+void CRpcTable::erase(size_t idx) {
+    // backward-shift deletion, pull later entries of the chain into the hole
+    size_t hole = idx;
+    for (size_t i = (idx + 1) & (CAPACITY - 1); _entries[i].used; i = (i + 1) & (CAPACITY - 1)) {
+        size_t h = home(_entries[i].id);
+
+        // entry can move only if its home slot is not between the hole and its position
+        bool movable = (hole <= i) ? (h <= hole || h > i) : (h <= hole && h > i);
+        if (!movable) continue;
+        _entries[hole] = std::move(_entries[i]);
+        hole = i;
+    }
+    _entries[hole] = entry();
+    _count--;
+}
+
+bool CRpcTable::add(uint32_t &id, std::future<std::vector<uint8_t>> &result) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_count >= RPC_MAX_IN_FLIGHT) return false;
+
+    // skip 0 and any id still in flight after wraparound
+    do {
+        id = _next_id++;
+    } while (!id || find(id) >= 0);
+
+    size_t i = home(id);
+    while (_entries[i].used) i = (i + 1) & (CAPACITY - 1);
+
+    entry &e = _entries[i];
+    e.used = true;
+    e.id = id;
+    e.timer = 0;
+    e.result = std::promise<std::vector<uint8_t>>();
+    result = e.result.get_future();
+    _count++;
+    return true;
+}
+
+void CRpcTable::set_timer(uint32_t id, uint64_t timer) {
+    std::lock_guard<std::mutex> guard(_lock);
+    long idx = find(id);
+    if (idx >= 0) _entries[idx].timer = timer;
+}
+
+bool CRpcTable::complete(uint32_t id, std::vector<uint8_t> payload, uint64_t &timer) {
+    std::lock_guard<std::mutex> guard(_lock);
+    long idx = find(id);
+    if (idx < 0) return false;
+    timer = _entries[idx].timer;
+    _entries[idx].result.set_value(std::move(payload));
+    erase((size_t) idx);
+    return true;
+}
+
+bool CRpcTable::fail(uint32_t id, std::exception_ptr error) {
+    std::lock_guard<std::mutex> guard(_lock);
+    long idx = find(id);
+    if (idx < 0) return false;
+    _entries[idx].result.set_exception(std::move(error));
+    erase((size_t) idx);
+    return true;
+}
+
+std::vector<uint8_t> CRpcTable::make_frame(uint8_t type, uint32_t id, const std::vector<uint8_t> &payload) {
+    std::vector<uint8_t> frame;
+    frame.reserve(RPC_HEADER_SIZE + payload.size());
+    frame.push_back(type);
+    for (int i = 0; i < 4; i++) frame.push_back((uint8_t) (id >> (8 * i)));
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return frame;
+}
+
+bool CRpcTable::parse_frame(const uint8_t *data, size_t len, uint8_t &type, uint32_t &id) {
+    if (len < RPC_HEADER_SIZE || (data[0] != RPC_TYPE_CALL && data[0] != RPC_TYPE_REPLY)) return false;
+    type = data[0];
+    id = (uint32_t) data[1] | ((uint32_t) data[2] << 8) | ((uint32_t) data[3] << 16) | ((uint32_t) data[4] << 24);
+    return true;
+}
+
+size_t CRpcTable::get_in_flight() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _count;
+}
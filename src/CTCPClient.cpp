@@ -10,6 +10,7 @@ CTCPClient::CTCPClient() = default;
 
 CTCPClient::~CTCPClient() {
     setdn();
+    CMetrics::global().remove_endpoint(_metrics);
 }
 
 bool CTCPClient::init_net() {
@@ -19,47 +20,12 @@ bool CTCPClient::init_net() {
         return false;
     }
 
-#ifdef WIN32
-    // initialize winsock
-    if (WSAStartup(0x0101, &_wsdat)) {
-        WSACleanup();
-        return false;
-    }
-#endif
-
-    // create new socket, exit on failure
-    if ((_socket_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-        spdlog::error("Error opening socket");
-#ifdef WIN32
-        WSACleanup();
-#endif
-        return false;
-    }
-
-    spdlog::info("Setting socket to nonblocking.");
-#ifdef WIN32
-    const long CMD = FIONBIO;
-    u_long arg = 1; // 0 for blocking, 1 for nonblocking
-    if (ioctlsocket(_socket_fd,CMD,&arg) < 0) {
-        spdlog::error("Error setting socket to nonblocking");
-        WSACleanup();
-        return false;
-    }
-#else
-    // set nonblocking
-    int flags = fcntl(_socket_fd, F_GETFL, 0);
-    if (fcntl(_socket_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
-        spdlog::error("Error setting socket to nonblocking");
-        return false;
-    }
-#endif
+    if (!open_socket(true)) return false;
 
     spdlog::info("Connecting to " + _host + ":" + std::to_string(_port));
 
     // set server details
-    _server_addr.sin_family = AF_INET;
-    _server_addr.sin_port = htons(_port);
-    _server_addr.sin_addr.s_addr = inet_addr(_host.data());
+    _server_addr = make_addr(_host, _port);
     _server_addr_len = sizeof(_server_addr);
 
     // expect -1 here, but why??
@@ -85,62 +51,71 @@ void CTCPClient::setup(const std::string &host, const std::string &port) {
     std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(20));
 }
 
-void CTCPClient::setdn() const {
-#ifdef WIN32
-    closesocket(_socket_fd);
-    WSACleanup();
-#else
-    close(_socket_fd);
-#endif
+void CTCPClient::setdn() {
+    _socket_ok = false;
+    _zerocopy.reap();
+    close_socket();
+
+    // completions for the old socket never come, a new one numbers its sends from 0
+    _zerocopy.reset();
 }
 
 bool CTCPClient::do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
     // check if socket is ok
     if (!_socket_ok) {
-        spdlog::error("Socket error during tx");
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
         return false;
     }
 
-    // preallocate receiving buffer
-    std::vector<uint8_t> rx_raw;
-    rx_raw.clear();
-    rx_raw.resize(UDP_MAX_SIZE);
-
     // reset rx return code
     _rx_code = 0;
 
-    auto timeout_start = std::chrono::steady_clock::now();
-    auto time_since_start = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - timeout_start).count();
-
-    // spins until complete response
-    while (_rx_code <= 0 && _socket_ok && (int) time_since_start < TCP_TIMEOUT) {
-        // rx data
-        time_since_start = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - timeout_start).count();
+    // let the kernel enforce the deadline instead of spinning on the clock
 #ifdef WIN32
-        _rx_code = recv(_socket_fd, reinterpret_cast<char *>(rx_raw.data()), (int) rx_raw.capacity(), 0);
+    WSAPOLLFD pfd{};
+    pfd.fd = _socket_fd;
+    pfd.events = POLLIN;
+    int ready = WSAPoll(&pfd, 1, TCP_TIMEOUT);
 #else
-        _rx_code = recv(_socket_fd, rx_raw.data(), rx_raw.capacity(), 0);
+    pollfd pfd{};
+    pfd.fd = _socket_fd;
+    pfd.events = POLLIN;
+    int ready = poll(&pfd, 1, TCP_TIMEOUT);
 #endif
-    }
 
-    if (time_since_start >= TCP_TIMEOUT) {
-        spdlog::warn("TCP Timed out");
+    if (!ready) {
+        NET_LOG_LIMITED(spdlog::level::warn, "TCP Timed out");
         return false;
     }
 
+#ifndef WIN32
+    // zero-copy completions wake us up too, they are not data
+    if (ready > 0 && (pfd.revents & POLLERR) && _zerocopy.reap() && !(pfd.revents & POLLIN)) return false;
+#endif
+
+    if (ready > 0) {
+#ifdef WIN32
+        _rx_code = recv(_socket_fd, reinterpret_cast<char *>(_recv_buffer.data()), (int) _recv_buffer.size(), 0);
+#else
+        _rx_code = recv(_socket_fd, _recv_buffer.data(), _recv_buffer.size(), 0);
+#endif
+    } else {
+        _rx_code = -1;
+    }
+
     if (_rx_code < 0) {
-        spdlog::error("General error during rx");
+        NET_LOG_LIMITED(spdlog::level::err, "General error during rx");
         return false;
     }
 
     if (!_rx_code) {
-        spdlog::warn("No data received");
+        NET_LOG_LIMITED(spdlog::level::warn, "No data received");
         return false;
     }
 
-    rx_buf = std::vector<uint8_t>(rx_raw.begin(), rx_raw.begin() + _rx_code);
+    CMetrics::global().inc(_metrics.rx_packets);
+    CMetrics::global().inc(_metrics.rx_bytes, _rx_code);
+    rx_buf.assign(_recv_buffer.data(), _recv_buffer.data() + _rx_code);
     rx_bytes = (long) rx_buf.size();
     return true;
 }
@@ -148,7 +123,7 @@ bool CTCPClient::do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
 bool CTCPClient::do_tx(const std::vector<uint8_t> &tx_buf) {
     // check if socket is ok
     if (!_socket_ok) {
-        spdlog::error("Socket error during tx");
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
         return false;
     }
 
@@ -161,12 +136,105 @@ bool CTCPClient::do_tx(const std::vector<uint8_t> &tx_buf) {
 
     // if problem with sending data, return false
     if (_tx_code < 0) {
-        spdlog::error("General error during tx");
+        NET_LOG_LIMITED(spdlog::level::err, "General error during tx");
+        CMetrics::global().inc(_metrics.tx_errors);
         return false;
     }
+    CMetrics::global().inc(_metrics.tx_packets);
+    CMetrics::global().inc(_metrics.tx_bytes, _tx_code);
     return true;
 }
 
+bool CTCPClient::do_tx_zerocopy(std::vector<uint8_t> &&tx_buf) {
+    // check if socket is ok
+    if (!_socket_ok) {
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
+        _zerocopy.release(std::move(tx_buf));
+        return false;
+    }
+
+    // earlier buffers may be done by now
+    _zerocopy.reap();
+
+    // small sends are cheaper to copy than to pin and wait for a completion
+    if (!_zerocopy.use_for(tx_buf.size())) {
+        bool ok = tx_stream(tx_buf.data(), tx_buf.size(), nullptr);
+        _zerocopy.release(std::move(tx_buf));
+        return ok;
+    }
+
+    CZeroCopy::held &zc = _zerocopy.hold(std::move(tx_buf));
+    bool ok = tx_stream(zc.buf.data(), zc.buf.size(), &zc);
+    _zerocopy.seal(zc);
+    return ok;
+}
+
+bool CTCPClient::tx_stream(const uint8_t *data, size_t len, CZeroCopy::held *zc) {
+    size_t offset = 0;
+    while (offset < len) {
+#ifdef WIN32
+        _tx_code = send(_socket_fd, reinterpret_cast<const char *>(data + offset), (int) (len - offset), 0);
+        bool would_block = _tx_code < 0 && WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        if (zc) {
+            iovec iov{const_cast<uint8_t *>(data + offset), len - offset};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            _tx_code = _zerocopy.send(*zc, &msg);
+
+            // too many completions outstanding for the socket's option memory, copy this part
+            if (_tx_code < 0 && errno == ENOBUFS) {
+                _zerocopy.reap();
+                _tx_code = send(_socket_fd, data + offset, len - offset, 0);
+            }
+        } else {
+            _tx_code = send(_socket_fd, data + offset, len - offset, 0);
+        }
+        bool would_block = _tx_code < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+
+        if (_tx_code > 0) {
+            offset += _tx_code;
+            continue;
+        }
+
+        // socket buffer is full, wait for the peer to take some
+        if (would_block) {
+#ifdef WIN32
+            WSAPOLLFD pfd{};
+            pfd.fd = _socket_fd;
+            pfd.events = POLLOUT;
+            int ready = WSAPoll(&pfd, 1, TCP_TIMEOUT);
+#else
+            pollfd pfd{};
+            pfd.fd = _socket_fd;
+            pfd.events = POLLOUT;
+            int ready = poll(&pfd, 1, TCP_TIMEOUT);
+            if (ready > 0 && (pfd.revents & POLLERR)) _zerocopy.reap();
+#endif
+            if (ready > 0) continue;
+        }
+
+        NET_LOG_LIMITED(spdlog::level::err, "General error during tx");
+        CMetrics::global().inc(_metrics.tx_errors);
+        return false;
+    }
+    CMetrics::global().inc(_metrics.tx_packets);
+    CMetrics::global().inc(_metrics.tx_bytes, (uint64_t) len);
+    return true;
+}
+
+bool CTCPClient::enable_zerocopy(bool enable, size_t threshold) {
+    if (_socket_ok && _zerocopy.enable(_socket_fd, enable, threshold)) return true;
+    spdlog::warn("MSG_ZEROCOPY not available, copying all sends");
+    return false;
+}
+
+CZeroCopy &CTCPClient::zerocopy() {
+    return _zerocopy;
+}
+
 bool CTCPClient::get_socket_status() {
     return _socket_ok;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+/**
+ * CTimerWheel.cpp - Hierarchical timer wheel code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CTimerWheel.hpp"
+
+CTimerWheel::CTimerWheel(uint32_t tick_ms) : _tick_ms(tick_ms ? tick_ms : 1) {
+    for (auto &level : _slots) {
+        for (auto &head : level) head = -1;
+    }
+}
+
+int32_t CTimerWheel::alloc_node() {
+    if (_free >= 0) {
+        int32_t idx = _free;
+        _free = _nodes[idx].next;
+        return idx;
+    }
+    _nodes.emplace_back();
+    return (int32_t) _nodes.size() - 1;
+}
+
+void CTimerWheel::link(int32_t idx) {
+    node &n = _nodes[idx];
+    uint64_t delta = n.expiry > _tick ? n.expiry - _tick : 0;
+
+    // pick the finest level whose span covers the delay
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= ((uint64_t) 1 << (TW_SLOT_BITS * (level + 1)))) level++;
+
+    // past the top level, park in the furthest slot and re-link when it cascades
+    uint64_t when = n.expiry;
+    uint64_t span = (uint64_t) 1 << (TW_SLOT_BITS * TW_LEVELS);
+    if (delta >= span) when = _tick + span - 1;
+
+    n.level = (int16_t) level;
+    n.slot = (int16_t) ((when >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1));
+    n.prev = -1;
+    n.next = _slots[level][n.slot];
+    if (n.next >= 0) _nodes[n.next].prev = idx;
+    _slots[level][n.slot] = idx;
+}
+
+void CTimerWheel::unlink(int32_t idx) {
+    node &n = _nodes[idx];
+    if (n.prev >= 0) {
+        _nodes[n.prev].next = n.next;
+    } else {
+        _slots[n.level][n.slot] = n.next;
+    }
+    if (n.next >= 0) _nodes[n.next].prev = n.prev;
+    n.level = -1;
+    n.slot = -1;
+    n.prev = -1;
+    n.next = -1;
+}
+
+void CTimerWheel::cascade(int level) {
+    int slot = (int) ((_tick >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1));
+    int32_t idx = _slots[level][slot];
+    _slots[level][slot] = -1;
+
+    // everything here is now within reach of a finer level
+    while (idx >= 0) {
+        int32_t next = _nodes[idx].next;
+        link(idx);
+        idx = next;
+    }
+}
+
+CTimerWheel::timer_id CTimerWheel::schedule(uint32_t delay_ms, timer_callback cb) {
+    std::lock_guard<std::mutex> guard(_lock);
+    int32_t idx = alloc_node();
+    node &n = _nodes[idx];
+    n.cb = std::move(cb);
+
+    // round up, a timer never fires early
+    uint64_t ticks = (delay_ms + _tick_ms - 1) / _tick_ms;
+    n.expiry = _tick + (ticks ? ticks : 1);
+    link(idx);
+    _pending++;
+    return ((uint64_t) n.generation << 32) | (uint32_t) (idx + 1);
+}
+
+bool CTimerWheel::cancel(timer_id id) {
+    if (!id) return false;
+    std::lock_guard<std::mutex> guard(_lock);
+    auto idx = (int32_t) ((id & 0xFFFFFFFF) - 1);
+    auto generation = (uint32_t) (id >> 32);
+    if (idx < 0 || idx >= (int32_t) _nodes.size()) return false;
+
+    node &n = _nodes[idx];
+    if (n.level < 0 || n.generation != generation) return false;
+
+    unlink(idx);
+    n.cb = nullptr;
+    n.generation++;
+    n.next = _free;
+    _free = idx;
+    _pending--;
+    return true;
+}
+
+size_t CTimerWheel::advance(int64_t now_ms) {
+    std::vector<timer_callback> fired;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_started) {
+            _origin_ms = now_ms - (int64_t) (_tick * _tick_ms);
+            _started = true;
+        }
+        if (now_ms < _origin_ms) return 0;
+        auto target = (uint64_t) (now_ms - _origin_ms) / _tick_ms;
+
+        while (_tick < target) {
+            // nothing to fire, skip straight to the target
+            if (!_pending) {
+                _tick = target;
+                break;
+            }
+
+            _tick++;
+
+            // refill finer levels each time a coarser slot comes up
+            for (int level = 1; level < TW_LEVELS; level++) {
+                if (_tick & (((uint64_t) 1 << (TW_SLOT_BITS * level)) - 1)) break;
+                cascade(level);
+            }
+
+            int slot = (int) (_tick & (TW_SLOTS - 1));
+            int32_t idx = _slots[0][slot];
+            _slots[0][slot] = -1;
+            while (idx >= 0) {
+                node &n = _nodes[idx];
+                int32_t next = n.next;
+                fired.push_back(std::move(n.cb));
+                n.cb = nullptr;
+                n.level = -1;
+                n.slot = -1;
+                n.prev = -1;
+                n.generation++;
+                n.next = _free;
+                _free = idx;
+                _pending--;
+                idx = next;
+            }
+        }
+    }
+
+    for (auto &cb : fired) {
+        if (cb) cb();
+    }
+    return fired.size();
+}
+
+size_t CTimerWheel::advance() {
+    return advance(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t CTimerWheel::get_pending() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _pending;
+}
@@ -0,0 +1,274 @@
+/**
+ * CTrace.cpp - Datagram trace capture and reading code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CTrace.hpp"
+
+#include <algorithm>
+
+static_assert(sizeof(trace_record) == 24, "trace_record is part of the file format");
+
+// fault the whole chunk in at once instead of a page at a time while copying
+#ifdef MAP_POPULATE
+#define TRACE_MAP_FLAGS MAP_POPULATE
+#else
+#define TRACE_MAP_FLAGS 0
+#endif
+
+static size_t round_up(size_t n, size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+CTrace::CTrace(size_t ring_size) {
+    _ring_size = 1;
+    while (_ring_size < std::max<size_t>(ring_size, 2 * TRACE_ALIGN)) _ring_size <<= 1;
+    _mask = _ring_size - 1;
+    _ring.reset(new block[_ring_size / TRACE_ALIGN]());
+    static_assert(sizeof(slot) <= TRACE_ALIGN, "slot header must fit in one ring block");
+}
+
+CTrace::~CTrace() {
+    close();
+}
+
+bool CTrace::open(const std::string &path) {
+    close();
+#ifdef WIN32
+    spdlog::warn("Trace capture is not available on Windows");
+    return false;
+#else
+    if ((_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+        spdlog::error("Error opening trace file " + path);
+        return false;
+    }
+    _map = nullptr;
+    _map_offset = 0;
+    _written = 0;
+    _failed = false;
+
+    trace_file_header header{};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.record_header = sizeof(trace_record);
+    header.start_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _start_ns = now_ns();
+    if (!write(&header, sizeof(header))) {
+        spdlog::error("Error writing trace file " + path);
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+
+    _running = true;
+    _thread = std::thread(&CTrace::run, this);
+    _open = true;
+    spdlog::info("Recording trace to " + path);
+    return true;
+#endif
+}
+
+void CTrace::close() {
+    if (!_thread.joinable()) return;
+    _open = false;
+    _running = false;
+    _thread.join();
+#ifndef WIN32
+    if (_map) munmap(_map, TRACE_FILE_CHUNK);
+    _map = nullptr;
+    // the last chunk was only partly used
+    if (ftruncate(_fd, (off_t) _written) < 0) spdlog::warn("Error trimming trace file");
+    ::close(_fd);
+    _fd = -1;
+#endif
+}
+
+void CTrace::record(direction dir, const sockaddr_in &peer, const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len) {
+    size_t need = round_up(sizeof(slot) + a_len + b_len, TRACE_ALIGN);
+    if (need > _ring_size / 2) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // claim space, plus filler if the record would run past the end of the ring
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    uint64_t pad;
+    do {
+        size_t offset = head & _mask;
+        pad = offset + need > _ring_size ? _ring_size - offset : 0;
+        if (head + pad + need - _tail.load(std::memory_order_acquire) > _ring_size) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!_head.compare_exchange_weak(head, head + pad + need, std::memory_order_relaxed));
+
+    if (pad) {
+        slot *filler = at(head);
+        filler->size = (uint32_t) pad;
+        filler->state.store(SLOT_PAD, std::memory_order_release);
+    }
+
+    slot *s = at(head + pad);
+    s->size = (uint32_t) need;
+    s->rec.time_ns = now_ns();
+    s->rec.addr = peer.sin_addr.s_addr;
+    s->rec.port = peer.sin_port;
+    s->rec.dir = dir;
+    s->rec.reserved = 0;
+    s->rec.len = (uint32_t) (a_len + b_len);
+    s->rec.reserved2 = 0;
+    auto *data = reinterpret_cast<unsigned char *>(s + 1);
+    std::memcpy(data, a, a_len);
+    if (b_len) std::memcpy(data + a_len, b, b_len);
+    s->state.store(SLOT_READY, std::memory_order_release);
+}
+
+bool CTrace::drain() {
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+    uint64_t start = tail;
+    static const unsigned char zeros[8] = {};
+
+    // a record claimed but not yet published stops the writer until its producer finishes
+    for (;;) {
+        slot *s = at(tail);
+        uint32_t state = s->state.load(std::memory_order_acquire);
+        if (state == SLOT_FREE) break;
+        uint32_t size = s->size;
+        if (state == SLOT_READY && s->rec.time_ns >= _start_ns) {
+            // times are relative to open() in the file
+            trace_record rec = s->rec;
+            rec.time_ns -= _start_ns;
+            size_t padded = round_up(rec.len, 8);
+            if (write(&rec, sizeof(rec)) && write(s + 1, rec.len) && write(zeros, padded - rec.len)) {
+                _recorded.fetch_add(1, std::memory_order_relaxed);
+                _bytes.store(_written, std::memory_order_relaxed);
+            }
+        }
+        // any block of this record can hold a slot header next time around
+        std::memset(reinterpret_cast<void *>(s), 0, size);
+        tail += size;
+    }
+    if (tail == start) return false;
+    _tail.store(tail, std::memory_order_release);
+    return true;
+}
+
+bool CTrace::write(const void *data, size_t len) {
+#ifdef WIN32
+    return false;
+#else
+    if (_failed) return false;
+    auto *bytes = static_cast<const unsigned char *>(data);
+    while (len) {
+        if (!_map || _written == _map_offset + TRACE_FILE_CHUNK) {
+            // grow by a chunk and map it
+            uint64_t offset = _map ? _map_offset + TRACE_FILE_CHUNK : 0;
+            if (_map) munmap(_map, TRACE_FILE_CHUNK);
+            _map = nullptr;
+            void *map = MAP_FAILED;
+            if (ftruncate(_fd, (off_t) (offset + TRACE_FILE_CHUNK)) == 0) {
+                map = mmap(nullptr, TRACE_FILE_CHUNK, PROT_READ | PROT_WRITE, MAP_SHARED | TRACE_MAP_FLAGS, _fd, (off_t) offset);
+            }
+            if (map == MAP_FAILED) {
+                // e.g. disk full, producers stop and the file keeps what was written
+                spdlog::error("Error growing trace file, recording stopped");
+                _open = false;
+                _failed = true;
+                return false;
+            }
+            _map = static_cast<unsigned char *>(map);
+            _map_offset = offset;
+        }
+        size_t n = std::min<uint64_t>(len, _map_offset + TRACE_FILE_CHUNK - _written);
+        std::memcpy(_map + (_written - _map_offset), bytes, n);
+        _written += n;
+        bytes += n;
+        len -= n;
+    }
+    return true;
+#endif
+}
+
+void CTrace::run() {
+    while (_running) {
+        if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_IDLE_WAIT));
+    }
+    // whatever was published before close()
+    drain();
+}
+
+trace_stats CTrace::get_stats() const {
+    trace_stats stats;
+    stats.recorded = _recorded.load(std::memory_order_relaxed);
+    stats.bytes = _bytes.load(std::memory_order_relaxed);
+    stats.dropped = _dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+CTraceReader::~CTraceReader() {
+    close();
+}
+
+bool CTraceReader::open(const std::string &path) {
+    close();
+#ifdef WIN32
+    spdlog::warn("Trace reading is not available on Windows");
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        spdlog::error("Error opening trace file " + path);
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(trace_file_header)) {
+        spdlog::error("Not a trace file: " + path);
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        spdlog::error("Error mapping trace file " + path);
+        return false;
+    }
+    _map = static_cast<const unsigned char *>(map);
+    _size = (size_t) st.st_size;
+
+    std::memcpy(&_header, _map, sizeof(_header));
+    if (std::memcmp(_header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || _header.version != TRACE_VERSION ||
+        _header.record_header != sizeof(trace_record)) {
+        spdlog::error("Not a trace file or unsupported version: " + path);
+        close();
+        return false;
+    }
+    madvise(const_cast<unsigned char *>(_map), _size, MADV_SEQUENTIAL);
+    rewind();
+    return true;
+#endif
+}
+
+void CTraceReader::close() {
+#ifndef WIN32
+    if (_map) munmap(const_cast<unsigned char *>(_map), _size);
+#endif
+    _map = nullptr;
+    _size = 0;
+    _pos = 0;
+}
+
+bool CTraceReader::next(trace_record &rec, const uint8_t *&data) {
+    if (!_map || _pos + sizeof(trace_record) > _size) return false;
+    std::memcpy(&rec, _map + _pos, sizeof(rec));
+
+    // unused space after a crash is zero, and a record must fit in what is left
+    if ((rec.dir != CTrace::TRACE_RX && rec.dir != CTrace::TRACE_TX) || rec.len > _size - _pos - sizeof(rec)) return false;
+    data = _map + _pos + sizeof(rec);
+    _pos += sizeof(rec) + round_up(rec.len, 8);
+    return true;
+}
+
+void CTraceReader::rewind() {
+    _pos = sizeof(trace_file_header);
+}
@@ -13,10 +13,38 @@
 
 #include "../include/CUDPClient.hpp"
 
-CUDPClient::CUDPClient() = default;
+CUDPClient::CUDPClient() {
+    // liveness is already recorded by do_rx. an ACK to a handshake also carries the caps the
+    // server agreed to, and every handshake starts the codec over, both ends send a keyframe
+    // next. heartbeat ACKs are a single byte and leave the codec alone
+    _dispatcher.on_frame(FRAME_ACK, [this](const uint8_t *data, size_t len, const sockaddr_in &) {
+        if (len < 2) return;
+        uint8_t caps = (uint8_t) (data[1] & _caps_request);
+        _codec.reset(caps & NET_CAP_CODEC);
+        _tx_crc = caps & NET_CAP_CRC;
+    });
+
+    // server is shutting down, keep retrying until it comes back
+    _dispatcher.on_frame(FRAME_EOT, [this](const uint8_t *, size_t, const sockaddr_in &) {
+        spdlog::warn("Server said goodbye");
+        set_state(CONN_LOST);
+    });
+
+    // RPC replies complete their call
+    _dispatcher.on_frame(RPC_TYPE_REPLY, [this](const uint8_t *data, size_t len, const sockaddr_in &) {
+        uint8_t type;
+        uint32_t id;
+        uint64_t timer = 0;
+        if (CRpcTable::parse_frame(data, len, type, id) &&
+            _rpc.complete(id, std::vector<uint8_t>(data + RPC_HEADER_SIZE, data + len), timer)) {
+            _timers.cancel(timer);
+        }
+    });
+}
 
 CUDPClient::~CUDPClient() {
     setdn();
+    CMetrics::global().remove_endpoint(_metrics);
 }
 
 bool CUDPClient::init_net() {
@@ -26,57 +54,20 @@ bool CUDPClient::init_net() {
         return false;
     }
 
-#ifdef WIN32
-    // initialize winsock
-    if (WSAStartup(0x0101, &_wsdat)) {
-        WSACleanup();
-        return false;
-    }
-#endif
-
-    // create new socket, exit on failure
-    if ((_socket_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
-        spdlog::error("Error opening socket");
-#ifdef WIN32
-        WSACleanup();
-#endif
-        return false;
-    }
-
-    spdlog::info("Setting socket to nonblocking.");
-#ifdef WIN32
-    const long CMD = FIONBIO;
-    u_long arg = 1; // 0 for blocking, 1 for nonblocking
-    if (ioctlsocket(_socket_fd,CMD,&arg) < 0) {
-        spdlog::error("Error setting socket to nonblocking");
-        WSACleanup();
-        return false;
-    }
-#else
-    // set nonblocking
-    int flags = fcntl(_socket_fd, F_GETFL, 0);
-    if (fcntl(_socket_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
-        spdlog::error("Error setting socket to nonblocking");
-        return false;
-    }
-#endif
+    if (!open_socket(true)) return false;
 
     spdlog::info("Connecting to " + _host + ":" + std::to_string(_port));
 
     // set server details
-    _server_addr.sin_family = AF_INET;
-    _server_addr.sin_port = htons(_port);
-    _server_addr.sin_addr.s_addr = inet_addr(_host.data());
-
-    do {
-        spdlog::info("Sending ENQ...");
-        _socket_ok = ping();
-        if (_socket_ok) {
-            spdlog::info("ACK received");
-        } else {
-            spdlog::info("Timeout");
-        }
-    } while (!_socket_ok);
+    _server_addr = make_addr(_host, _port);
+    _server_addr_len = sizeof(_server_addr);
+    _socket_ok = true;
+
+    // handshake completes in the background, do_rx picks up the ACK
+    set_state(CONN_CONNECTING);
+    handshake();
+    _timers.cancel(_keepalive);
+    _keepalive = _timers.schedule(HANDSHAKE_RETRY, [this]() { on_keepalive(); });
 
     spdlog::info("Sending to udp://" + _host + ":" + std::to_string(_port));
     return true;
@@ -92,61 +83,93 @@ void CUDPClient::setup(const std::string &host, const std::string &port) {
     }
 }
 
-void CUDPClient::setdn() const {
-#ifdef WIN32
-    closesocket(_socket_fd);
-    WSACleanup();
-#else
-    close(_socket_fd);
-#endif
+void CUDPClient::setdn() {
+    // stop the keepalive chain, another setup() starts its own
+    _timers.cancel(_keepalive);
+    _keepalive = 0;
+
+    // tell the server so it can drop our session now instead of timing it out
+    if (_socket_ok) tx_frame(std::vector<uint8_t>{FRAME_EOT}, true);
+    _socket_ok = false;
+    _zerocopy.reap();
+    close_socket();
+
+    // completions for the old socket never come, a new one numbers its sends from 0
+    _zerocopy.reset();
+    set_state(CONN_CLOSED);
 }
 
 bool CUDPClient::ping() {
-    // send prefix and ENQ
-    std::string buffer = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + " \5";
+    // send ENQ, the ACK is picked up by do_rx
+    NET_HOT_INFO("Sending ENQ...");
+    _last_enq_ms = now_ms();
+    return tx_frame(std::vector<uint8_t>{FRAME_ENQ}, true);
+}
 
-    if (!(sendto(_socket_fd, buffer.data(), buffer.size(), 0,
-                 (struct sockaddr *) &_server_addr, sizeof(_server_addr)))) {
-        spdlog::error("General error during ping tx");
-        return false;
-    }
+bool CUDPClient::handshake() {
+    // ask for the payload codec and checksums, older servers ignore the extra byte.
+    // only handshakes carry it, a heartbeat would start the codec over on both ends
+    if (!_caps_request) return ping();
+    NET_HOT_INFO("Sending ENQ...");
+    _last_enq_ms = now_ms();
+    return tx_frame(std::vector<uint8_t>{FRAME_ENQ, _caps_request}, true);
+}
 
-    _server_addr_len = sizeof(_server_addr);
-    _bytes_moved = 0;
-
-    auto ping_timeout_start = std::chrono::steady_clock::now();
-    buffer.clear();
-    buffer.resize(UDP_MAX_SIZE);
-
-    // spins until ping response or timeout
-    while (_bytes_moved <= 0) {
-        _bytes_moved = recvfrom(_socket_fd, buffer.data(), buffer.size(), 0,
-                                (struct sockaddr *) &_server_addr, &_server_addr_len);
-        if ((int) std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - ping_timeout_start).count() > PING_TIMEOUT) {
-            spdlog::warn("No response to ping.");
-            return false;
-        }
-    }
+void CUDPClient::service() {
+    if (!_socket_ok) return;
+    _timers.advance(now_ms());
+    service_reliable();
+    _zerocopy.reap();
+    CNetLog::flush_suppressed();
+}
 
-    // turn rx into ss
-    std::stringstream rx_raw(std::string(buffer.begin(),buffer.begin() + _bytes_moved));
+void CUDPClient::on_keepalive() {
+    int64_t now = now_ms();
+    int64_t since_rx = now - _last_rx_ms;
+    int64_t since_enq = now - _last_enq_ms;
+    uint32_t next = HEARTBEAT_INTERVAL;
+
+    switch (get_state()) {
+        case CONN_CONNECTING:
+        case CONN_LOST:
+            handshake();
+            next = HANDSHAKE_RETRY;
+            break;
+        case CONN_CONNECTED:
+            if (since_rx > PING_TIMEOUT) {
+                spdlog::warn("Server is gone...");
+                set_state(CONN_LOST);
+                handshake();
+                next = HANDSHAKE_RETRY;
+            } else if (since_rx >= HEARTBEAT_INTERVAL && since_enq >= HEARTBEAT_INTERVAL) {
+                // only needed when there is no data coming back to prove the server is alive
+                ping();
+            }
+            break;
+        default:
+            return;
+    }
 
-    // split ss into time and data
-    std::string time, data;
-    rx_raw >> time;
-    rx_raw >> data;
+    // one self-rearming timer covers handshake, heartbeat and liveness
+    _keepalive = _timers.schedule(next, [this]() { on_keepalive(); });
+}
 
-    return (data == "\6");
+void CUDPClient::set_state(conn_state state) {
+    auto from = (conn_state) _state.exchange(state);
+    if (from == state) return;
+    if (state == CONN_CONNECTED) spdlog::info("Connected to udp://" + _host + ":" + std::to_string(_port));
+    if (_on_state) _on_state(from, state);
 }
 
-bool CUDPClient::do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
+void CUDPClient::set_state_callback(state_callback cb) {
+    _on_state = std::move(cb);
+}
 
-    // preallocate receiving buffer
-    std::vector<uint8_t> rx_raw;
-    rx_raw.clear();
-    rx_raw.resize(UDP_MAX_SIZE);
+CUDPClient::conn_state CUDPClient::get_state() const {
+    return (conn_state) _state.load();
+}
 
+bool CUDPClient::do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
     // get length of server address
     _server_addr_len = sizeof(_server_addr);
 
@@ -155,79 +178,487 @@ bool CUDPClient::do_rx(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
 
     // spins until complete response
     while (_rx_code <= 0 && _socket_ok) {
-        // send data
-
-
 #ifdef WIN32
-        _rx_code = recvfrom(_socket_fd, reinterpret_cast<char *>(rx_raw.data()), (int) rx_raw.capacity(), 0,
+        _rx_code = recvfrom(_socket_fd, reinterpret_cast<char *>(_recv_buffer.data()), (int) _recv_buffer.size(), 0,
                             (struct sockaddr *) &_server_addr, &_server_addr_len);
 #else
-        _rx_code = recvfrom(_socket_fd, rx_raw.data(), rx_raw.capacity(), 0,
+        _rx_code = recvfrom(_socket_fd, _recv_buffer.data(), _recv_buffer.size(), 0,
                             (struct sockaddr *) &_server_addr, &_server_addr_len);
 #endif
+        if (_rx_code < 0) {
+            // nothing there yet, anything else is a real error and is reported below
+            if (!would_block()) break;
+            if (!interrupted()) CMetrics::global().inc(_metrics.rx_eagain);
+        }
     }
 
     if (_rx_code < 0) {
-        spdlog::error("General error during rx");
+        NET_LOG_LIMITED(spdlog::level::err, "General error during rx");
         return false;
     }
 
     if (!_rx_code) {
-        spdlog::warn("No data received");
+        NET_LOG_LIMITED(spdlog::level::warn, "No data received");
+        return false;
+    }
+
+    CMetrics::global().inc(_metrics.rx_packets);
+    CMetrics::global().inc(_metrics.rx_bytes, _rx_code);
+    if (_trace.is_open()) _trace.record(CTrace::TRACE_RX, _server_addr, _recv_buffer.data(), _rx_code);
+
+    // split into time and body in place
+    frame_header hdr;
+    if (!CFrame::parse(_recv_buffer.data(), _rx_code, hdr)) {
+        NET_LOG_LIMITED(spdlog::level::err, "Malformed data received");
+        CMetrics::global().inc(_metrics.rx_malformed);
         return false;
     }
+    if (!CFrame::check_crc(_recv_buffer.data(), _rx_code, hdr)) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Checksum mismatch, dropping datagram");
+        CMetrics::global().inc(_metrics.rx_bad_crc);
+        return false;
+    }
+    const uint8_t *body = _recv_buffer.data() + hdr.body_start;
+    size_t body_len = _rx_code - hdr.body_start;
+    int64_t now_wall = timestamp_ms();
+
+    // older peers send only <time>
+    if (hdr.has_seq) _rx_stats.on_rx(hdr.seq, hdr.time_ms, now_wall);
+
+    // anything from the server proves it is alive, no separate heartbeat needed
+    _last_rx_ms = now_ms();
+    if (get_state() != CONN_CONNECTED) set_state(CONN_CONNECTED);
+
+    // reliable frames carry the server's clock, not our echoed timestamp
+    bool control = hdr.control;
+    if (!control || !CReliableChannel::is_reliable_frame(body[0])) _response_time_ms = (int) (now_wall - hdr.time_ms);
 
-    // turn rx into ss
-    std::stringstream rx_raw_ss(std::string(rx_raw.begin(),rx_raw.begin() + _rx_code));
+    // codec frames are turned back into the payload the server sent
+    if (control && CDeltaCodec::is_codec_frame(body[0])) {
+        if (body[0] == DC_TYPE_ACK) {
+            _codec.on_ack(body, body_len);
+            return false;
+        }
+        if (!_codec.decode(body, body_len, _rx_decoded)) {
+            NET_LOG_LIMITED(spdlog::level::warn, "Undecodable codec frame, waiting for keyframe");
+            CMetrics::global().inc(_metrics.rx_malformed);
+            return false;
+        }
+        body = _rx_decoded.data();
+        body_len = _rx_decoded.size();
+        control = false;
+        if (!body_len) return false;
+    }
 
-    // split ss into time and data
-    std::string time, data;
-    rx_raw_ss >> time;
-    rx_raw_ss >> data;
+    // control and protocol frames are handled here and never reach the app
+    if (_dispatcher.dispatch(body, body_len, _server_addr, control)) return false;
 
-    // measure response time
-    _response_time_ms = (int) (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - std::stoll(time));
-    if (data.empty()) {
-        spdlog::error("Malformed data received");
+    // held back until its playout time, do_rx_playout hands it out
+    if (_jitter && hdr.has_seq) {
+        _jitter->push(hdr.seq, hdr.time_ms, body, body_len, now_wall);
         return false;
     }
 
-    rx_buf = std::vector<uint8_t>(rx_raw.begin() + (int) time.length() + 1, rx_raw.begin() + _rx_code);
+    rx_buf.assign(body, body + body_len);
     rx_bytes = (long) rx_buf.size();
     return true;
 }
 
+bool CUDPClient::tx_frame(const std::vector<uint8_t> &body, bool control) {
+    return tx_frame(body.data(), body.size(), control);
+}
+
+std::string CUDPClient::tx_prefix(const uint8_t *head, size_t head_len, const uint8_t *body, size_t len, bool control) {
+    std::string prefix;
+    frame_prefix(prefix, std::to_string(timestamp_ms()), _tx_seq.fetch_add(1, std::memory_order_relaxed), true, control, _tx_crc,
+                 head, head_len, body, len);
+    if (head_len) prefix.append(reinterpret_cast<const char *>(head), head_len);
+    return prefix;
+}
+
+bool CUDPClient::tx_frame(const uint8_t *body, size_t len, bool control) {
+    std::string now = tx_prefix(nullptr, 0, body, len, control);
+    std::vector<uint8_t> tx_this;
+    tx_this.reserve(now.size() + len);
+    tx_this.insert(tx_this.end(), now.begin(), now.end());
+    tx_this.insert(tx_this.end(), body, body + len);
+
+    // send message to server
+#ifdef WIN32
+    ssize_t sent = sendto(_socket_fd, reinterpret_cast<const char *>(tx_this.data()), tx_this.size(), 0,
+                          (struct sockaddr *) &_server_addr, _server_addr_len);
+#else
+    ssize_t sent = sendto(_socket_fd, tx_this.data(), tx_this.size(), 0, (struct sockaddr *) &_server_addr, _server_addr_len);
+#endif
+
+    // if problem with sending data, return false
+    if (sent < 0) {
+        NET_LOG_LIMITED(spdlog::level::err, "General error during tx");
+        CMetrics::global().inc(_metrics.tx_errors);
+        return false;
+    }
+    CMetrics::global().inc(_metrics.tx_packets);
+    CMetrics::global().inc(_metrics.tx_bytes, sent);
+    if (_trace.is_open()) _trace.record(CTrace::TRACE_TX, _server_addr, tx_this.data(), tx_this.size());
+    return true;
+}
+
 bool CUDPClient::do_tx(const std::vector<uint8_t> &tx_buf) {
+    return do_tx(tx_buf.data(), tx_buf.size());
+}
+
+bool CUDPClient::do_tx(const uint8_t *tx_buf, size_t len) {
     // check if socket is ok
     if (!_socket_ok) {
-        spdlog::error("Socket error during tx");
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
         return false;
     }
 
-    std::string now = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + " ";;
-    std::vector<uint8_t> tx_this(now.begin(), now.end());
-    tx_this.insert(tx_this.end(),tx_buf.begin(),tx_buf.end());
+    // delta/compress if agreed on in the handshake, codec frames are library frames
+    bool encoded = _codec.encode(tx_buf, len, _tx_encoded);
+    if (encoded) {
+        tx_buf = _tx_encoded.data();
+        len = _tx_encoded.size();
+    }
 
-    // send message to server
+    // spread bulk sends out instead of bursting them onto the wire
+    _pacer.wait(len);
+    return tx_frame(tx_buf, len, encoded);
+}
+
+bool CUDPClient::do_tx_chunks(const std::vector<uint8_t> &tx_buf, size_t chunk) {
+    return do_tx_chunks(tx_buf.data(), tx_buf.size(), chunk);
+}
+
+bool CUDPClient::do_tx_chunks(const uint8_t *data, size_t len, size_t chunk) {
+    if (!_socket_ok) {
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
+        return false;
+    }
+    if (!len || !chunk) return false;
+    return tx_chunks(data, len, chunk, true, nullptr);
+}
+
+bool CUDPClient::do_tx_zerocopy(std::vector<uint8_t> &&tx_buf, size_t chunk) {
+    if (!_socket_ok) {
+        NET_LOG_LIMITED(spdlog::level::err, "Socket error during tx");
+        _zerocopy.release(std::move(tx_buf));
+        return false;
+    }
+
+    // earlier buffers may be done by now
+    _zerocopy.reap();
+
+    // a zero-copy send takes at most ZC_MAX_FRAGS pages and every prefix costs one, which
+    // limits how many datagrams a GSO send can carry. small chunks end up cheaper to copy
+    size_t send_size = chunk ? chunk : tx_buf.size();
+    if (chunk && _gso) {
+        size_t per_send = std::max<size_t>(ZC_MAX_FRAGS / (CZeroCopy::max_frags(chunk) + CZeroCopy::max_frags(FRAME_PREFIX_MAX + CH_HEADER_SIZE)), 1);
+        send_size = std::min({tx_buf.size(), per_send * chunk, (size_t) GSO_MAX_BYTES});
+    }
+
+    // the codec writes a new buffer anyway, and small sends are cheaper to copy than to pin
+    if ((!chunk && _codec.get_caps()) || !_zerocopy.use_for(send_size)) {
+        bool ok = chunk ? do_tx_chunks(tx_buf, chunk) : do_tx(tx_buf);
+        _zerocopy.release(std::move(tx_buf));
+        return ok;
+    }
+
+    CZeroCopy::held &zc = _zerocopy.hold(std::move(tx_buf));
+    bool ok = tx_chunks(zc.buf.data(), zc.buf.size(), chunk ? chunk : zc.buf.size(), chunk != 0, &zc);
+    _zerocopy.seal(zc);
+    return ok;
+}
+
+bool CUDPClient::tx_chunks(const uint8_t *data, size_t len, size_t chunk, bool split, CZeroCopy::held *zc) {
+    // pieces of a split message carry its id and their place in it, so the server can put it back together
+    size_t count = (len + chunk - 1) / chunk;
+    if (split && count > CH_MAX_CHUNKS) {
+        NET_LOG_LIMITED(spdlog::level::err, "Too many chunks in one message");
+        return false;
+    }
+    auto id = (uint16_t) (split ? _chunk_id.fetch_add(1, std::memory_order_relaxed) : 0);
+    uint8_t head[CH_HEADER_SIZE];
+
+    // the kernel reads zero-copy prefixes after we return, so they are kept with the buffer.
+    // reserved up front so the pointers handed to the kernel never move
+    std::string &prefixes = zc ? zc->scratch : _gso_prefixes;
+    prefixes.clear();
+    prefixes.reserve((zc ? count : GSO_MAX_SEGMENTS) * (FRAME_PREFIX_MAX + CH_HEADER_SIZE));
+
+    // each chunk is a whole datagram with its own prefix, GSO needs them all the same size
+    // except the last one in a send, so a send ends early if the prefix grows a digit
+    bool ok = true;
+    size_t segment = 0;
+    size_t batch_bytes = 0;
+    size_t batch_frags = 0;
+    bool short_segment = false;
+    _gso_batch.clear();
+    for (size_t offset = 0; offset < len; offset += chunk) {
+        size_t n = std::min(chunk, len - offset);
+        if (split) CChunkAssembler::make_header(head, id, (uint16_t) (offset / chunk), (uint16_t) count);
+        std::string prefix = tx_prefix(head, split ? CH_HEADER_SIZE : 0, data + offset, n, split);
+        size_t datagram = prefix.size() + n;
+        size_t frags = zc ? CZeroCopy::frags(prefixes.data() + prefixes.size(), prefix.size()) + CZeroCopy::frags(data + offset, n) : 0;
+        if (!_gso_batch.empty() && (datagram > segment || short_segment || _gso_batch.size() == GSO_MAX_SEGMENTS ||
+                                    batch_bytes + datagram > GSO_MAX_BYTES || batch_frags + frags > ZC_MAX_FRAGS)) {
+            ok &= tx_segments(segment, prefixes, zc);
+            _gso_batch.clear();
+            batch_bytes = 0;
+            batch_frags = 0;
+            if (!zc) prefixes.clear();
+        }
+        if (_gso_batch.empty()) segment = datagram;
+        short_segment = datagram < segment;
+        _gso_batch.push_back({prefixes.size(), prefix.size(), data + offset, n});
+        prefixes += prefix;
+        batch_bytes += datagram;
+        batch_frags += frags;
+    }
+    if (!_gso_batch.empty()) ok &= tx_segments(segment, prefixes, zc);
+    return ok;
+}
+
+#ifndef WIN32
+ssize_t CUDPClient::tx_msg(const msghdr *msg, size_t len, CZeroCopy::held *zc) {
+    if (zc && _zerocopy.use_for(len)) {
+        ssize_t sent = _zerocopy.send(*zc, msg);
+        if (sent >= 0 || (errno != ENOBUFS && errno != EMSGSIZE)) return sent;
+
+        // too many completions outstanding for the socket's option memory, or more pages
+        // than one send can pin (a datagram near UDP_MAX_SIZE), copy this one
+        _zerocopy.reap();
+    }
+    return sendmsg(_socket_fd, msg, 0);
+}
+#endif
+
+bool CUDPClient::tx_segments(size_t segment, const std::string &prefixes, CZeroCopy::held *zc) {
+    size_t count = _gso_batch.size();
+    size_t total = 0;
+    ssize_t sent;
+    for (const tx_datagram &d : _gso_batch) total += d.prefix_len + d.len;
+
+    // spread bulk sends out instead of bursting them onto the wire
+    _pacer.wait(total);
+
+#ifndef WIN32
+    // prefix and chunk of every datagram back to back, the kernel gathers them
+    iovec iov[2 * GSO_MAX_SEGMENTS];
+    for (size_t i = 0; i < count; i++) {
+        iov[2 * i] = {const_cast<char *>(prefixes.data() + _gso_batch[i].prefix), _gso_batch[i].prefix_len};
+        iov[2 * i + 1] = {const_cast<uint8_t *>(_gso_batch[i].data), _gso_batch[i].len};
+    }
+    msghdr msg{};
+    msg.msg_name = &_server_addr;
+    msg.msg_namelen = _server_addr_len;
+
+#ifdef UDP_SEGMENT
+    if (_gso && count > 1) {
+        // one syscall, the kernel (or NIC) cuts the buffer into segment-sized datagrams
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2 * count;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        auto gso_size = (uint16_t) segment;
+        std::memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+        sent = tx_msg(&msg, total, zc);
+        if (sent >= 0) {
+            CMetrics::global().inc(_metrics.tx_packets, count);
+            CMetrics::global().inc(_metrics.tx_bytes, sent);
+            for (size_t i = 0; _trace.is_open() && i < count; i++) trace_datagram(i, prefixes);
+            return true;
+        }
+        if (errno == EMSGSIZE) {
+            // segments larger than the path MTU can't be offloaded, only this batch goes one by one
+            NET_LOG_LIMITED(spdlog::level::warn, "GSO segment exceeds path MTU, sending datagrams one by one");
+        } else if (errno == EIO || errno == EINVAL || errno == EOPNOTSUPP) {
+            // e.g. no checksum offload on the egress device, send them one by one from now on
+            spdlog::warn("GSO send failed, falling back to one datagram per send");
+            _gso = false;
+        } else {
+            NET_LOG_LIMITED(spdlog::level::err, "General error during tx");
+            CMetrics::global().inc(_metrics.tx_errors);
+            return false;
+        }
+        msg.msg_control = nullptr;
+        msg.msg_controllen = 0;
+    }
+#endif
+#endif
+
+    bool ok = true;
+    for (size_t i = 0; i < count; i++) {
+        const tx_datagram &d = _gso_batch[i];
 #ifdef WIN32
-    _tx_code = sendto(_socket_fd, reinterpret_cast<const char *>(tx_this.data()), tx_this.size(), 0,
+        _gso_buffer.assign(prefixes.begin() + d.prefix, prefixes.begin() + d.prefix + d.prefix_len);
+        _gso_buffer.insert(_gso_buffer.end(), d.data, d.data + d.len);
+        sent = sendto(_socket_fd, reinterpret_cast<const char *>(_gso_buffer.data()), (int) _gso_buffer.size(), 0,
                       (struct sockaddr *) &_server_addr, _server_addr_len);
 #else
-    _tx_code = sendto(_socket_fd, tx_this.data(), tx_this.size(), 0, (struct sockaddr *) &_server_addr, _server_addr_len);
+        msg.msg_iov = iov + 2 * i;
+        msg.msg_iovlen = 2;
+        sent = tx_msg(&msg, d.prefix_len + d.len, zc);
 #endif
+        if (sent < 0) {
+            NET_LOG_LIMITED(spdlog::level::err, "General error during tx");
+            CMetrics::global().inc(_metrics.tx_errors);
+            ok = false;
+            continue;
+        }
+        CMetrics::global().inc(_metrics.tx_packets);
+        CMetrics::global().inc(_metrics.tx_bytes, sent);
+        if (_trace.is_open()) trace_datagram(i, prefixes);
+    }
+    return ok;
+}
 
-    // if problem with sending data, return false
-    if (_tx_code < 0) {
-        spdlog::error("General error during tx");
+void CUDPClient::trace_datagram(size_t i, const std::string &prefixes) {
+    const tx_datagram &d = _gso_batch[i];
+    _trace.record(CTrace::TRACE_TX, _server_addr, reinterpret_cast<const uint8_t *>(prefixes.data() + d.prefix), d.prefix_len, d.data, d.len);
+}
+
+bool CUDPClient::enable_gso(bool enable) {
+    _gso = false;
+    if (!enable) return true;
+#ifdef UDP_SEGMENT
+    // kernels without GSO (before 4.18) don't know the option
+    int size = 0;
+    socklen_t size_len = sizeof(size);
+    if (_socket_ok && !getsockopt(_socket_fd, SOL_UDP, UDP_SEGMENT, &size, &size_len)) {
+        _gso = true;
+        return true;
+    }
+#endif
+    spdlog::warn("UDP GSO not available, sending one datagram per chunk");
+    return false;
+}
+
+bool CUDPClient::enable_zerocopy(bool enable, size_t threshold) {
+    if (_socket_ok && _zerocopy.enable(_socket_fd, enable, threshold)) return true;
+    spdlog::warn("MSG_ZEROCOPY not available, copying all sends");
+    return false;
+}
+
+bool CUDPClient::enable_trace(const std::string &path) {
+    if (path.empty()) {
+        _trace.close();
+        return true;
+    }
+    return _trace.open(path);
+}
+
+CTrace &CUDPClient::trace() {
+    return _trace;
+}
+
+CZeroCopy &CUDPClient::zerocopy() {
+    return _zerocopy;
+}
+
+std::future<std::vector<uint8_t>> CUDPClient::call(const std::vector<uint8_t> &payload, uint32_t timeout_ms) {
+    uint32_t id = 0;
+    std::future<std::vector<uint8_t>> result;
+    if (!_rpc.add(id, result)) {
+        std::promise<std::vector<uint8_t>> rejected;
+        rejected.set_exception(std::make_exception_ptr(std::runtime_error("Too many RPC calls in flight")));
+        return rejected.get_future();
+    }
+
+    // timeout is run by service(), a reply that arrives first cancels it
+    _rpc.set_timer(id, _timers.schedule(timeout_ms, [this, id]() {
+        _rpc.fail(id, std::make_exception_ptr(std::runtime_error("RPC call timed out")));
+    }));
+
+    if (!_socket_ok || !tx_frame(CRpcTable::make_frame(RPC_TYPE_CALL, id, payload), true)) {
+        _rpc.fail(id, std::make_exception_ptr(std::runtime_error("RPC call could not be sent")));
+    }
+    return result;
+}
+
+void CUDPClient::enable_reliable(size_t window) {
+    _reliable = std::make_unique<CReliableChannel>([this](const std::vector<uint8_t> &frame) {
+        return _socket_ok && tx_frame(frame, true);
+    }, window);
+
+    auto on_frame = [this](const uint8_t *data, size_t len, const sockaddr_in &) {
+        _reliable->on_rx(data, len);
+    };
+    _dispatcher.on_frame(RC_TYPE_DATA, on_frame);
+    _dispatcher.on_frame(RC_TYPE_SACK, on_frame);
+}
+
+bool CUDPClient::do_tx_reliable(const std::vector<uint8_t> &tx_buf) {
+    if (!_reliable) {
+        NET_LOG_LIMITED(spdlog::level::err, "Reliable channel not enabled");
         return false;
     }
+    bool sent = _reliable->send(tx_buf);
+    CMetrics::global().set(_metrics.in_flight, (int64_t) _reliable->get_in_flight());
+    return sent;
+}
+
+bool CUDPClient::do_rx_reliable(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
+    if (!_reliable || !_reliable->recv(rx_buf)) return false;
+    rx_bytes = (long) rx_buf.size();
     return true;
 }
 
+void CUDPClient::service_reliable() {
+    if (!_reliable) return;
+    _reliable->service();
+    CMetrics::global().set(_metrics.in_flight, (int64_t) _reliable->get_in_flight());
+}
+
+void CUDPClient::enable_jitter_buffer(size_t capacity, int64_t min_delay_ms, int64_t max_delay_ms) {
+    _jitter = std::make_unique<CJitterBuffer>(capacity, min_delay_ms, max_delay_ms);
+}
+
+bool CUDPClient::do_rx_playout(std::vector<uint8_t> &rx_buf, long &rx_bytes) {
+    int64_t now_wall = timestamp_ms();
+    if (!_jitter || !_jitter->pop(rx_buf, now_wall)) return false;
+    rx_bytes = (long) rx_buf.size();
+    return true;
+}
+
+jitter_stats CUDPClient::get_jitter_stats() const {
+    return _jitter ? _jitter->get_stats() : jitter_stats{};
+}
+
+void CUDPClient::enable_compression(uint8_t caps) {
+    _caps_request = (uint8_t) ((_caps_request & ~NET_CAP_CODEC) | (caps & NET_CAP_CODEC));
+}
+
+uint8_t CUDPClient::get_compression() {
+    return _codec.get_caps();
+}
+
+void CUDPClient::enable_checksum(bool enable) {
+    _caps_request = (uint8_t) (enable ? _caps_request | NET_CAP_CRC : _caps_request & ~NET_CAP_CRC);
+}
+
+bool CUDPClient::get_checksum() {
+    return _tx_crc;
+}
+
+CDispatcher &CUDPClient::dispatcher() {
+    return _dispatcher;
+}
+
 bool CUDPClient::get_socket_status() {
     return _socket_ok;
 }
 
 int CUDPClient::get_last_response_time() {
     return _response_time_ms;
+}
+
+peer_stats CUDPClient::get_rx_stats() const {
+    return _rx_stats.snapshot();
 }
\ No newline at end of file
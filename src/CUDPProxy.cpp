@@ -0,0 +1,236 @@
+/**
+ * CUDPProxy.cpp - Impairing UDP proxy code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CUDPProxy.hpp"
+
+static bool set_nonblocking(int fd) {
+#ifdef WIN32
+    u_long arg = 1;
+    return ioctlsocket(fd, FIONBIO, &arg) >= 0;
+#else
+    int flags = fcntl(fd, F_GETFL, 0);
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0;
+#endif
+}
+
+CUDPProxy::CUDPProxy(const impairment_config &up, const impairment_config &down) : _up(up), _down(down) {
+}
+
+CUDPProxy::~CUDPProxy() {
+    stop();
+}
+
+int64_t CUDPProxy::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CUDPProxy::close_fd(int fd) {
+#ifdef WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+bool CUDPProxy::start(const std::string &listen_port, const std::string &host, const std::string &port) {
+    stop();
+
+#ifdef WIN32
+    // initialize winsock
+    if (WSAStartup(0x0101, &_wsdat)) {
+        WSACleanup();
+        return false;
+    }
+#endif
+
+    if ((_listen_fd = (int) socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        spdlog::error("Error opening proxy socket");
+        return false;
+    }
+
+    sockaddr_in listen_addr{};
+    listen_addr.sin_family = AF_INET;
+    listen_addr.sin_port = htons(std::stoi(listen_port));
+    listen_addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(_listen_fd, (struct sockaddr *) &listen_addr, sizeof(listen_addr)) < 0 || !set_nonblocking(_listen_fd)) {
+        spdlog::error("Error binding proxy to port " + listen_port);
+        close_fd(_listen_fd);
+        _listen_fd = -1;
+        return false;
+    }
+
+    _server_addr = {};
+    _server_addr.sin_family = AF_INET;
+    _server_addr.sin_port = htons(std::stoi(port));
+    _server_addr.sin_addr.s_addr = inet_addr(host.data());
+
+    _buffer.resize(PROXY_BUFFER_SIZE);
+    _running = true;
+    _thread = std::thread(&CUDPProxy::run, this);
+    spdlog::info("Proxying udp://0.0.0.0:" + listen_port + " to udp://" + host + ":" + port);
+    return true;
+}
+
+void CUDPProxy::stop() {
+    _running = false;
+    if (_thread.joinable()) _thread.join();
+    for (client &c : _clients) close_fd(c.fd);
+    _clients.clear();
+    _queue.clear();
+    if (_listen_fd >= 0) {
+        close_fd(_listen_fd);
+        _listen_fd = -1;
+#ifdef WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+void CUDPProxy::configure(const impairment_config &up, const impairment_config &down) {
+    _up.configure(up);
+    _down.configure(down);
+}
+
+CUDPProxy::client *CUDPProxy::get_client(const sockaddr_in &addr) {
+    for (client &c : _clients) {
+        if (c.addr.sin_addr.s_addr == addr.sin_addr.s_addr && c.addr.sin_port == addr.sin_port) {
+            c.last_us = now_us();
+            return &c;
+        }
+    }
+    if (_clients.size() >= PROXY_MAX_CLIENTS) return nullptr;
+
+    // the server tells clients apart by address, so each one gets its own socket
+    int fd = (int) socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0 || !set_nonblocking(fd)) {
+        if (fd >= 0) close_fd(fd);
+        return nullptr;
+    }
+    _clients.push_back({addr, fd, now_us()});
+    spdlog::info("Proxying new client " + std::string(inet_ntoa(addr.sin_addr)) + ":" + std::to_string(ntohs(addr.sin_port)));
+    return &_clients.back();
+}
+
+void CUDPProxy::expire_clients(int64_t now) {
+    for (size_t i = 0; i < _clients.size();) {
+        client &c = _clients[i];
+        if (now - c.last_us < (int64_t) PROXY_CLIENT_IDLE * 1000) {
+            i++;
+            continue;
+        }
+
+        // packets still waiting to go out from its socket go with it, the fd may be reused
+        for (auto it = _queue.begin(); it != _queue.end();) {
+            it = it->second.fd == c.fd ? _queue.erase(it) : std::next(it);
+        }
+        spdlog::info("Proxy client " + std::string(inet_ntoa(c.addr.sin_addr)) + ":" + std::to_string(ntohs(c.addr.sin_port)) + " went quiet, freeing its slot");
+        close_fd(c.fd);
+        _clients.erase(_clients.begin() + (long) i);
+    }
+}
+
+void CUDPProxy::read_some(int fd, bool upstream) {
+    // bounded so a flood can't hold up deliveries
+    for (int i = 0; i < PROXY_READ_BATCH; i++) {
+        sockaddr_in src{};
+        socklen_t src_len = sizeof(src);
+#ifdef WIN32
+        int len = recvfrom(fd, reinterpret_cast<char *>(_buffer.data()), (int) _buffer.size(), 0, (struct sockaddr *) &src, &src_len);
+#else
+        ssize_t len = recvfrom(fd, _buffer.data(), _buffer.size(), 0, (struct sockaddr *) &src, &src_len);
+#endif
+        if (len < 0) return;
+
+        // client to server leaves through the client's own socket, server to client through the listening one
+        pending p{};
+        if (upstream) {
+            client *c = get_client(src);
+            if (!c) {
+                NET_LOG_LIMITED(spdlog::level::warn, "Too many proxy clients, dropping");
+                continue;
+            }
+            p.fd = c->fd;
+            p.dst = _server_addr;
+        } else {
+            // anyone can send to an upstream socket's port, only the server's replies go back
+            if (src.sin_addr.s_addr != _server_addr.sin_addr.s_addr || src.sin_port != _server_addr.sin_port) {
+                NET_LOG_LIMITED(spdlog::level::warn, "Datagram from someone other than the server, dropping");
+                continue;
+            }
+            bool found = false;
+            for (client &c : _clients) {
+                if (c.fd == fd) {
+                    p.dst = c.addr;
+                    c.last_us = now_us();
+                    found = true;
+                }
+            }
+            if (!found) continue;
+            p.fd = _listen_fd;
+        }
+
+        int64_t due[2];
+        size_t n = (upstream ? _up : _down).schedule((size_t) len, now_us(), due);
+        for (size_t i = 0; i < n; i++) {
+            if (_queue.size() >= PROXY_MAX_QUEUED) {
+                _overflowed++;
+                break;
+            }
+            p.data.assign(_buffer.begin(), _buffer.begin() + len);
+            _queue.emplace(due[i], p);
+        }
+    }
+}
+
+void CUDPProxy::run() {
+    std::vector<pollfd> fds;
+    while (_running) {
+        // send everything whose time has come
+        int64_t now = now_us();
+        while (!_queue.empty() && _queue.begin()->first <= now) {
+            const pending &p = _queue.begin()->second;
+#ifdef WIN32
+            sendto(p.fd, reinterpret_cast<const char *>(p.data.data()), (int) p.data.size(), 0, (struct sockaddr *) &p.dst, sizeof(p.dst));
+#else
+            sendto(p.fd, p.data.data(), p.data.size(), 0, (struct sockaddr *) &p.dst, sizeof(p.dst));
+#endif
+            _queue.erase(_queue.begin());
+        }
+        expire_clients(now);
+
+        fds.clear();
+        fds.push_back({(decltype(pollfd::fd)) _listen_fd, POLLIN, 0});
+        for (const client &c : _clients) fds.push_back({(decltype(pollfd::fd)) c.fd, POLLIN, 0});
+
+        // sleep until the next delivery or a packet comes in
+        int64_t wait_us = _queue.empty() ? PROXY_IDLE_WAIT * 1000 : _queue.begin()->first - now;
+#ifdef WIN32
+        int ready = WSAPoll(fds.data(), (ULONG) fds.size(), (int) ((wait_us + 999) / 1000));
+#elif defined(__linux__)
+        timespec timeout{(time_t) (wait_us / 1000000), (long) (wait_us % 1000000) * 1000};
+        int ready = ppoll(fds.data(), fds.size(), &timeout, nullptr);
+#else
+        int ready = poll(fds.data(), fds.size(), (int) ((wait_us + 999) / 1000));
+#endif
+        if (ready <= 0) continue;
+
+        for (size_t i = 0; i < fds.size(); i++) {
+            if (fds[i].revents & POLLIN) read_some((int) fds[i].fd, i == 0);
+        }
+    }
+}
+
+impairment_stats CUDPProxy::get_up_stats() {
+    return _up.get_stats();
+}
+
+impairment_stats CUDPProxy::get_down_stats() {
+    return _down.get_stats();
+}
+
+uint64_t CUDPProxy::get_overflowed() {
+    return _overflowed;
+}
@@ -6,10 +6,83 @@
 
 #include "../include/CUDPServer.hpp"
 
-CUDPServer::CUDPServer() = default;
+// nonzero key for a client address, used for per-client state
+static uint64_t peer_key(const sockaddr_in &peer) {
+    return ((uint64_t) peer.sin_addr.s_addr << 16) | peer.sin_port;
+}
+
+static sockaddr_in peer_addr(uint64_t key) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t) (key >> 16);
+    addr.sin_port = (uint16_t) (key & 0xFFFF);
+    return addr;
+}
+
+CUDPServer::CUDPServer() {
+    // answer ENQ straight away with its own timestamp
+    _dispatcher.on_frame(FRAME_ENQ, [this](const uint8_t *data, size_t len, const sockaddr_in &src) {
+        NET_HOT_INFO("Sending ping");
+        uint8_t ack[2] = {FRAME_ACK, 0};
+        bool crc = false;
+
+        // a handshake ENQ can ask for the payload codec and checksums, and starts the codec over on both ends
+        if (len > 1) {
+            ack[1] = data[1] & _caps;
+            uint8_t codec_caps = ack[1] & NET_CAP_CODEC;
+            crc = (ack[1] & NET_CAP_CRC) != 0;
+            std::lock_guard<std::mutex> guard(_session_lock);
+            session &peer = get_session(src);
+            peer.caps = ack[1];
+            peer.crc->store(crc, std::memory_order_relaxed);
+            if (!codec_caps) {
+                peer.codec.reset();
+            } else if (peer.codec) {
+                peer.codec->reset(codec_caps);
+            } else {
+                // codec acks carry the server's own time, like reliable frames
+                std::shared_ptr<std::atomic<bool>> crc = peer.crc;
+                peer.codec = std::make_shared<CDeltaCodec>([this, src, crc](const std::vector<uint8_t> &frame) {
+                    std::string now = std::to_string(timestamp_ms());
+                    return tx_frame(now, frame, src, true, crc->load(std::memory_order_relaxed));
+                }, codec_caps);
+            }
+        } else {
+            // heartbeat, leaves what was agreed on alone
+            crc = wants_crc(src);
+        }
+        tx_frame(_rx_time, ack, len > 1 ? 2 : 1, src, true, crc);
+    });
+
+    // client is going away, don't wait for its session to time out
+    _dispatcher.on_frame(FRAME_EOT, [this](const uint8_t *, size_t, const sockaddr_in &src) {
+        std::lock_guard<std::mutex> guard(_session_lock);
+        if (_sessions.erase(peer_key(src))) {
+            _peer_stats.release(peer_key(src));
+            spdlog::info("Session closed by " + std::string(inet_ntoa(src.sin_addr)) + ":" + std::to_string(ntohs(src.sin_port)));
+        }
+    });
+
+    // pieces of a do_tx_chunks message, do_rx hands it out once the last one is in
+    _dispatcher.on_frame(CH_TYPE_CHUNK, [this](const uint8_t *data, size_t len, const sockaddr_in &src) {
+        _chunks.on_rx(peer_key(src), data, len, now_ms());
+    });
+
+    // RPC calls are answered by the handler and echo their own timestamp
+    _dispatcher.on_frame(RPC_TYPE_CALL, [this](const uint8_t *data, size_t len, const sockaddr_in &src) {
+        uint8_t type;
+        uint32_t id;
+        std::vector<uint8_t> reply;
+        if (CRpcTable::parse_frame(data, len, type, id) && _rpc_handler &&
+            _rpc_handler(std::vector<uint8_t>(data + RPC_HEADER_SIZE, data + len), src, id, reply)) {
+            tx_frame(_rx_time, CRpcTable::make_frame(RPC_TYPE_REPLY, id, reply), src, true, wants_crc(src));
+        }
+    });
+}
 
 CUDPServer::~CUDPServer() {
     setdn();
+    CMetrics::global().remove_endpoint(_metrics);
 }
 
 bool CUDPServer::init_net() {
@@ -20,122 +93,381 @@ bool CUDPServer::init_net() {
         return false;
     }
 
-#ifdef WIN32
-    // initialize winsock
-    if (WSAStartup(0x0101, &_wsdat)) {
-        WSACleanup();
+    if (!open_socket(false) || !bind_any(_port, _server_addr)) return false;
+
+    spdlog::info("Listening on udp://0.0.0.0:" + std::to_string(_port));
+    spdlog::info("Socket init complete.");
+    return true;
+}
+
+bool CUDPServer::do_rx(
+        std::vector<uint8_t> &rx_processed,
+        sockaddr_in &src,
+        long &rx_bytes) {
+
+    // hand out the rest of a GRO batch before reading the socket again
+    if (_gro_offset >= (size_t) _rx_code && !rx_datagrams()) return false;
+    const uint8_t *datagram = _recv_buffer.data() + _gro_offset;
+    size_t datagram_len = std::min(_gro_segment, (size_t) _rx_code - _gro_offset);
+    _gro_offset += datagram_len;
+    CMetrics::global().inc(_metrics.rx_packets);
+    CMetrics::global().inc(_metrics.rx_bytes, datagram_len);
+    if (_trace.is_open()) _trace.record(CTrace::TRACE_RX, _client_addr, datagram, datagram_len);
+
+    // split into time and body in place
+    frame_header hdr;
+    if (!CFrame::parse(datagram, datagram_len, hdr)) {
+        NET_LOG_LIMITED(spdlog::level::err, "Malformed data received");
+        CMetrics::global().inc(_metrics.rx_malformed);
         return false;
     }
-#endif
-
-    // create new socket, exit on failure
-    if ((_socket_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
-        spdlog::error("Error opening socket");
-#ifdef WIN32
-        WSACleanup();
-#endif
+    if (!CFrame::check_crc(datagram, datagram_len, hdr)) {
+        NET_LOG_LIMITED(spdlog::level::warn, "Checksum mismatch, dropping datagram");
+        CMetrics::global().inc(_metrics.rx_bad_crc);
         return false;
     }
+    const uint8_t *body = datagram + hdr.body_start;
+    size_t body_len = datagram_len - hdr.body_start;
 
-    // bind program to address and port
-    _server_addr.sin_family = AF_INET;
-    _server_addr.sin_port = htons(_port);
-    _server_addr.sin_addr.s_addr = INADDR_ANY;
+    // any datagram keeps the client's session alive, not just reliable or codec frames
+    touch_session(_client_addr);
 
-    if ((bind(_socket_fd, (struct sockaddr *) &_server_addr, sizeof(_server_addr))) < 0) {
-        spdlog::error("Error binding to address");
-#ifdef WIN32
-        closesocket(_socket_fd);
-        WSACleanup();
-#else
-        close(_socket_fd);
-#endif
-        return false;
+    // older clients and pings send only <time>
+    if (hdr.has_seq) {
+        CPeerStats *stats = _peer_stats.get(peer_key(_client_addr));
+        if (stats) {
+            stats->on_rx(hdr.seq, hdr.time_ms, timestamp_ms());
+        }
     }
 
-    spdlog::info("Listening on udp://0.0.0.0:" + std::to_string(_port));
-    spdlog::info("Socket init complete.");
+    // timestamp digits to echo, short enough to stay in the string's inline storage
+    _rx_time.assign(reinterpret_cast<const char *>(datagram), hdr.time_len);
+
+    // codec frames are turned back into the payload the client sent
+    bool control = hdr.control;
+    if (control && CDeltaCodec::is_codec_frame(body[0])) {
+        std::shared_ptr<CDeltaCodec> codec = get_codec(_client_addr);
+        if (!codec) {
+            NET_LOG_LIMITED(spdlog::level::warn, "Codec frame from client without a codec session");
+            CMetrics::global().inc(_metrics.rx_malformed);
+            return false;
+        }
+        if (body[0] == DC_TYPE_ACK) {
+            codec->on_ack(body, body_len);
+            return false;
+        }
+        if (!codec->decode(body, body_len, _rx_decoded)) {
+            NET_LOG_LIMITED(spdlog::level::warn, "Undecodable codec frame, waiting for keyframe");
+            CMetrics::global().inc(_metrics.rx_malformed);
+            return false;
+        }
+        body = _rx_decoded.data();
+        body_len = _rx_decoded.size();
+        control = false;
+        if (!body_len) return false;
+    }
+
+    // control and protocol frames are handled here and never reach the app or the time queue,
+    // except a chunk that completes a message, which is returned in its place
+    if (_dispatcher.dispatch(body, body_len, _client_addr, control)) {
+        if (!_chunks.pop(_rx_assembled)) return false;
+        body = _rx_assembled.data();
+        body_len = _rx_assembled.size();
+    }
+
+    _rx_time_queue.emplace(_rx_time);
+    CMetrics::global().set(_metrics.queue_depth, (int64_t) _rx_time_queue.size());
+
+    rx_processed.assign(body, body + body_len);
+    rx_bytes = (long) rx_processed.size();
+    src = _client_addr;
     return true;
 }
 
-bool CUDPServer::do_rx(
-        std::vector<uint8_t> &rx_processed,
-        sockaddr_in &src,
-        long &rx_bytes) {
-    std::vector<uint8_t> rx_raw;
-    rx_raw.clear();
-    rx_raw.resize(UDP_MAX_SIZE);
+bool CUDPServer::rx_datagrams() {
+    _gro_offset = 0;
+    _gro_segment = 0;
 
     // listen for client
     _client_addr_len = sizeof(_client_addr);
-#ifdef WIN32
-    _rx_code = recvfrom(_socket_fd, reinterpret_cast<char *>(rx_raw.data()), (int) rx_raw.capacity(), 0, (struct sockaddr*) &_client_addr, &_client_addr_len);
-#else
-    _rx_code = recvfrom(_socket_fd, rx_raw.data(), rx_raw.capacity(), 0, (struct sockaddr *) &_client_addr, &_client_addr_len);
+#ifdef UDP_GRO
+    if (_gro) {
+        // with GRO one read can return many datagrams of one size back to back, the cmsg says which size
+        iovec iov{_recv_buffer.data(), _recv_buffer.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr msg{};
+        msg.msg_name = &_client_addr;
+        msg.msg_namelen = _client_addr_len;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        _rx_code = recvmsg(_socket_fd, &msg, 0);
+        for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); _rx_code >= 0 && cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                int segment;
+                std::memcpy(&segment, CMSG_DATA(cm), sizeof(segment));
+                _gro_segment = (size_t) segment;
+            }
+        }
+    } else
 #endif
-    if (_rx_code < 0) {
-        spdlog::error("Error reading data.");
+    {
 #ifdef WIN32
-        closesocket(_socket_fd);
-        WSACleanup();
+        _rx_code = recvfrom(_socket_fd, reinterpret_cast<char *>(_recv_buffer.data()), (int) _recv_buffer.size(), 0, (struct sockaddr*) &_client_addr, &_client_addr_len);
 #else
-        close(_socket_fd);
+        _rx_code = recvfrom(_socket_fd, _recv_buffer.data(), _recv_buffer.size(), 0, (struct sockaddr *) &_client_addr, &_client_addr_len);
 #endif
-        return false;
     }
-
-    // turn rx into ss
-    std::stringstream rx_raw_ss(std::string(rx_raw.begin(),rx_raw.begin() + _rx_code));
-
-    // split ss into time and data
-    std::string time, data;
-    rx_raw_ss >> time;
-    _rx_time_queue.emplace(time);
-    rx_raw_ss >> data;
-    if (data.empty()) {
-        spdlog::error("Malformed data received");
+    if (_rx_code < 0) {
+        _rx_code = 0;
+        // interrupted or nothing to read, the socket is still good
+        if (would_block()) {
+            if (!interrupted()) CMetrics::global().inc(_metrics.rx_eagain);
+        } else {
+            NET_LOG_LIMITED(spdlog::level::err, "Error reading data.");
+        }
         return false;
     }
 
-    // respond if ping
-    if (data == "\5") {
-        spdlog::info("Sending ping");
-        std::string ping_string("\6");
-        do_tx(std::vector<uint8_t> (ping_string.begin(), ping_string.end()),_client_addr);
-    }
-
-    rx_processed = std::vector<uint8_t>(rx_raw.begin() + (int) (time.length()) + 1,rx_raw.begin() + _rx_code);
-    rx_bytes = (long) (((rx_raw.begin() + _rx_code) - rx_raw.begin()) - ((rx_raw.begin() + (int) (time.length()) + 1) - rx_raw.begin()));
-    src = _client_addr;
+    // a plain read is a single datagram
+    if (!_gro_segment) _gro_segment = (size_t) _rx_code;
     return true;
 }
 
+bool CUDPServer::enable_gro(bool enable) {
+    _gro = false;
+    if (!enable) return true;
+#ifdef UDP_GRO
+    int on = 1;
+    if (!setsockopt(_socket_fd, SOL_UDP, UDP_GRO, &on, sizeof(on))) {
+        _gro = true;
+        return true;
+    }
+#endif
+    spdlog::warn("UDP GRO not available, receiving one datagram per read");
+    return false;
+}
+
 bool CUDPServer::do_tx(const std::vector<uint8_t> &tx_buf,
                        sockaddr_in &dst) {
+    return do_tx(tx_buf.data(), tx_buf.size(), dst);
+}
+
+bool CUDPServer::do_tx(const uint8_t *tx_buf, size_t len, const sockaddr_in &dst) {
     if (_rx_time_queue.empty()) return false;
-    if (tx_buf.empty()) return false;
-    std::vector<uint8_t> tx_this(_rx_time_queue.front().begin(),_rx_time_queue.front().end());
+    if (!len) return false;
+    std::string time = _rx_time_queue.front();
     _rx_time_queue.pop();
-    tx_this.emplace_back(' ');
-    tx_this.insert(tx_this.end(),tx_buf.begin(),tx_buf.end());
+    CMetrics::global().set(_metrics.queue_depth, (int64_t) _rx_time_queue.size());
+
+    // delta/compress for clients that agreed on it in the handshake, codec frames are library frames
+    std::shared_ptr<CDeltaCodec> codec = get_codec(dst);
+    bool encoded = codec && codec->encode(tx_buf, len, _tx_encoded);
+    if (encoded) {
+        tx_buf = _tx_encoded.data();
+        len = _tx_encoded.size();
+    }
+
+    // spread bulk sends out instead of bursting them onto the wire
+    _pacer.wait(len);
+    return tx_frame(time, tx_buf, len, dst, encoded, wants_crc(dst));
+}
+
+bool CUDPServer::tx_frame(const std::string &time, const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst, bool control, bool crc) {
+    return tx_frame(time, tx_buf.data(), tx_buf.size(), dst, control, crc);
+}
+
+bool CUDPServer::tx_frame(const std::string &time, const uint8_t *tx_buf, size_t len, const sockaddr_in &dst, bool control, bool crc) {
+    // with the stats table full the client just doesn't get sequence numbers, like an older server's
+    std::string prefix;
+    uint32_t seq = 0;
+    bool has_seq = _peer_stats.next_tx_seq(peer_key(dst), seq);
+    frame_prefix(prefix, time, seq, has_seq, control, crc, nullptr, 0, tx_buf, len);
+    std::vector<uint8_t> tx_this;
+    tx_this.reserve(prefix.size() + len);
+    tx_this.insert(tx_this.end(), prefix.begin(), prefix.end());
+    tx_this.insert(tx_this.end(), tx_buf, tx_buf + len);
     // respond to client
 #ifdef WIN32
     if (sendto(_socket_fd, reinterpret_cast<const char *>(tx_this.data()), (int) tx_this.size(), 0, (struct sockaddr *) &dst, sizeof(dst)) < 0) {
 #else
     if (sendto(_socket_fd, tx_this.data(), tx_this.size(), 0, (struct sockaddr *) &dst, sizeof(dst)) < 0) {
 #endif
-        spdlog::error("Error sending data.");
-#ifdef WIN32
-        closesocket(_socket_fd);
-        WSACleanup();
-#else
-        close(_socket_fd);
-#endif
+        // one client's failed send must not take the socket away from the others
+        NET_LOG_LIMITED(spdlog::level::err, "Error sending data.");
+        CMetrics::global().inc(_metrics.tx_errors);
         return false;
     }
+    CMetrics::global().inc(_metrics.tx_packets);
+    CMetrics::global().inc(_metrics.tx_bytes, tx_this.size());
+    if (_trace.is_open()) _trace.record(CTrace::TRACE_TX, dst, tx_this.data(), tx_this.size());
     return true;
 }
 
+void CUDPServer::enable_reliable(size_t window) {
+    {
+        std::lock_guard<std::mutex> guard(_session_lock);
+        _reliable_window = window;
+    }
+
+    // reliable channel frames don't take part in timestamp echo
+    auto on_frame = [this](const uint8_t *data, size_t len, const sockaddr_in &src) {
+        get_reliable_peer(src)->on_rx(data, len);
+    };
+    _dispatcher.on_frame(RC_TYPE_DATA, on_frame);
+    _dispatcher.on_frame(RC_TYPE_SACK, on_frame);
+}
+
+CUDPServer::session &CUDPServer::get_session(const sockaddr_in &peer) {
+    uint64_t key = peer_key(peer);
+    auto it = _sessions.find(key);
+    if (it != _sessions.end()) return it->second;
+
+    session fresh;
+    fresh.crc = std::make_shared<std::atomic<bool>>(false);
+    fresh.last_rx_ms = now_ms();
+    _timers.schedule(SESSION_TIMEOUT, [this, key]() { expire_session(key); });
+    return _sessions.emplace(key, std::move(fresh)).first->second;
+}
+
+void CUDPServer::touch_session(const sockaddr_in &peer) {
+    std::lock_guard<std::mutex> guard(_session_lock);
+    auto it = _sessions.find(peer_key(peer));
+    if (it != _sessions.end()) it->second.last_rx_ms = now_ms();
+}
+
+std::shared_ptr<CReliableChannel> CUDPServer::get_reliable_peer(const sockaddr_in &peer) {
+    std::lock_guard<std::mutex> guard(_session_lock);
+    session &s = get_session(peer);
+    if (s.channel) return s.channel;
+
+    // reliable frames carry the server's own time, there is no client timestamp to echo
+    // the channel sends with its own lock held, so it must not take the session lock
+    std::shared_ptr<std::atomic<bool>> crc = s.crc;
+    s.channel = std::make_shared<CReliableChannel>([this, peer, crc](const std::vector<uint8_t> &frame) {
+        std::string now = std::to_string(timestamp_ms());
+        return tx_frame(now, frame, peer, true, crc->load(std::memory_order_relaxed));
+    }, _reliable_window);
+    return s.channel;
+}
+
+bool CUDPServer::wants_crc(const sockaddr_in &peer) {
+    if (!(_caps & NET_CAP_CRC)) return false;
+    std::lock_guard<std::mutex> guard(_session_lock);
+    auto it = _sessions.find(peer_key(peer));
+    return it != _sessions.end() && it->second.crc->load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<CDeltaCodec> CUDPServer::get_codec(const sockaddr_in &peer) {
+    std::lock_guard<std::mutex> guard(_session_lock);
+    auto it = _sessions.find(peer_key(peer));
+    if (it == _sessions.end()) return nullptr;
+    return it->second.codec;
+}
+
+void CUDPServer::expire_session(uint64_t key) {
+    std::lock_guard<std::mutex> guard(_session_lock);
+    auto it = _sessions.find(key);
+    if (it == _sessions.end()) return;
+
+    int64_t idle = now_ms() - it->second.last_rx_ms;
+    if (idle < SESSION_TIMEOUT) {
+        // activity since the timer was set, check again when it would next run out
+        _timers.schedule((uint32_t) (SESSION_TIMEOUT - idle), [this, key]() { expire_session(key); });
+        return;
+    }
+
+    sockaddr_in addr = peer_addr(key);
+    spdlog::info("Session expired for " + std::string(inet_ntoa(addr.sin_addr)) + ":" + std::to_string(ntohs(addr.sin_port)));
+    _sessions.erase(it);
+    _peer_stats.release(key);
+}
+
+bool CUDPServer::do_tx_reliable(const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst) {
+    if (!_reliable_window) {
+        NET_LOG_LIMITED(spdlog::level::err, "Reliable channel not enabled");
+        return false;
+    }
+    return get_reliable_peer(dst)->send(tx_buf);
+}
+
+bool CUDPServer::do_rx_reliable(std::vector<uint8_t> &rx_buf, sockaddr_in &src, long &rx_bytes) {
+    std::lock_guard<std::mutex> guard(_session_lock);
+    for (auto &peer : _sessions) {
+        if (peer.second.channel && peer.second.channel->recv(rx_buf)) {
+            src = peer_addr(peer.first);
+            rx_bytes = (long) rx_buf.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+void CUDPServer::service_reliable() {
+    // retransmits go out from service(), which must not run under the session lock
+    std::vector<std::shared_ptr<CReliableChannel>> channels;
+    {
+        std::lock_guard<std::mutex> guard(_session_lock);
+        for (auto &peer : _sessions) {
+            if (peer.second.channel) channels.push_back(peer.second.channel);
+        }
+    }
+    int64_t in_flight = 0;
+    for (auto &channel : channels) {
+        channel->service();
+        in_flight += (int64_t) channel->get_in_flight();
+    }
+    CMetrics::global().set(_metrics.in_flight, in_flight);
+}
+
+void CUDPServer::set_rpc_handler(rpc_handler handler) {
+    _rpc_handler = std::move(handler);
+}
+
+bool CUDPServer::do_tx_reply(uint32_t id, const std::vector<uint8_t> &tx_buf, const sockaddr_in &dst) {
+    // the call's timestamp is gone by now, use our own
+    std::string now = std::to_string(timestamp_ms());
+    return tx_frame(now, CRpcTable::make_frame(RPC_TYPE_REPLY, id, tx_buf), dst, true, wants_crc(dst));
+}
+
+void CUDPServer::enable_compression(uint8_t caps) {
+    _caps = (uint8_t) ((_caps & ~NET_CAP_CODEC) | (caps & NET_CAP_CODEC));
+}
+
+void CUDPServer::enable_checksum(bool enable) {
+    _caps = (uint8_t) (enable ? _caps | NET_CAP_CRC : _caps & ~NET_CAP_CRC);
+}
+
+CDispatcher &CUDPServer::dispatcher() {
+    return _dispatcher;
+}
+
+bool CUDPServer::enable_trace(const std::string &path) {
+    if (path.empty()) {
+        _trace.close();
+        return true;
+    }
+    return _trace.open(path);
+}
+
+CTrace &CUDPServer::trace() {
+    return _trace;
+}
+
+void CUDPServer::service() {
+    _timers.advance(now_ms());
+    service_reliable();
+    CNetLog::flush_suppressed();
+}
+
+void CUDPServer::get_peer_stats(std::vector<sockaddr_in> &peers, std::vector<peer_stats> &stats) const {
+    std::vector<uint64_t> keys;
+    _peer_stats.snapshot(keys, stats);
+    peers.clear();
+    for (uint64_t key : keys) peers.push_back(peer_addr(key));
+}
+
 void CUDPServer::setup(const std::string &port) {
     spdlog::info("Beginning UDP server setup.");
     _port = std::stoi(port);
@@ -145,11 +477,20 @@ void CUDPServer::setup(const std::string &port) {
     }
 }
 
-void CUDPServer::setdn() const {
-#ifdef WIN32
-    closesocket(_socket_fd);
-    WSACleanup();
-#else
-    close(_socket_fd);
-#endif
+void CUDPServer::setdn() {
+    // tell clients with a session we are going away, they go back to handshaking
+    if (_socket_fd >= 0) {
+        std::vector<std::pair<uint64_t, bool>> peers;
+        {
+            std::lock_guard<std::mutex> guard(_session_lock);
+            for (auto &peer : _sessions) peers.emplace_back(peer.first, peer.second.crc->load(std::memory_order_relaxed));
+            _sessions.clear();
+        }
+        std::string now = std::to_string(timestamp_ms());
+        for (auto &peer : peers) {
+            tx_frame(now, std::vector<uint8_t>{FRAME_EOT}, peer_addr(peer.first), true, peer.second);
+            _peer_stats.release(peer.first);
+        }
+    }
+    close_socket();
 }
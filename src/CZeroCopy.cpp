@@ -0,0 +1,223 @@
+/**
+ * CZeroCopy.cpp - MSG_ZEROCOPY send bookkeeping code
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include "../include/CZeroCopy.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include "../include/CNetLog.hpp"
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define ZC_SUPPORTED
+#endif
+
+bool CZeroCopy::enable(int fd, bool enable, size_t threshold) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _threshold = threshold;
+    if (!enable) {
+        _enabled = false;
+        return true;
+    }
+#ifdef ZC_SUPPORTED
+    int one = 1;
+    if (!setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one))) {
+        _fd = fd;
+        _enabled = true;
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool CZeroCopy::use_for(size_t len) const {
+    return _enabled && len >= _threshold;
+}
+
+void CZeroCopy::set_release_callback(release_callback cb) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _on_release = std::move(cb);
+}
+
+CZeroCopy::held &CZeroCopy::hold(std::vector<uint8_t> &&buf) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _held.emplace_back();
+    held &h = _held.back();
+    h.buf = std::move(buf);
+    h.first_id = _next_id;
+    return h;
+}
+
+#ifndef WIN32
+ssize_t CZeroCopy::send(held &h, const msghdr *msg, int flags) {
+#ifdef ZC_SUPPORTED
+    // locked so a reap on another thread can't see the completion before the send is counted
+    std::lock_guard<std::mutex> lock(_lock);
+    ssize_t sent = sendmsg(_fd, msg, flags | MSG_ZEROCOPY);
+
+    // a send that fails is not numbered, one that succeeds always is, even if it copied
+    if (sent >= 0) {
+        h.sends++;
+        _next_id++;
+    }
+    return sent;
+#else
+    (void) h;
+    (void) msg;
+    (void) flags;
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
+#endif
+
+void CZeroCopy::seal(held &h) {
+    std::vector<std::vector<uint8_t>> done;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        h.sealed = true;
+        collect(done);
+    }
+    release_all(done);
+}
+
+void CZeroCopy::release(std::vector<uint8_t> &&buf) {
+    release_callback cb;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        cb = _on_release;
+    }
+    if (cb) cb(std::move(buf));
+}
+
+bool CZeroCopy::reap() {
+#ifdef ZC_SUPPORTED
+    if (_fd < 0) return false;
+
+    bool any = false;
+    bool copied = false;
+    std::vector<std::vector<uint8_t>> done;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (;;) {
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+
+            for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                      (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) continue;
+                sock_extended_err err{};
+                std::memcpy(&err, CMSG_DATA(cm), sizeof(err));
+                if (err.ee_errno || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+                // sends ee_info to ee_data inclusive are done, spread them over the buffers they came from
+                uint32_t count = err.ee_data - err.ee_info + 1;
+                for (held &h : _held) {
+                    auto start = (int64_t) (int32_t) (h.first_id - err.ee_info);
+                    int64_t lo = std::max<int64_t>(start, 0);
+                    int64_t hi = std::min<int64_t>(start + h.sends, count);
+                    if (hi > lo) h.completed += (uint32_t) (hi - lo);
+                }
+                _completed += count;
+                if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                    _copied += count;
+                    copied = true;
+                }
+                any = true;
+            }
+        }
+        collect(done);
+    }
+
+    // happens over loopback or on devices without scatter-gather, zero-copy only adds overhead there
+    if (copied) NET_LOG_LIMITED(spdlog::level::info, "Zero-copy sends were copied by the kernel");
+    release_all(done);
+    return any;
+#else
+    return false;
+#endif
+}
+
+void CZeroCopy::reset() {
+    std::vector<std::vector<uint8_t>> done;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (held &h : _held) done.push_back(std::move(h.buf));
+        _held.clear();
+        _fd = -1;
+        _enabled = false;
+        _next_id = 0;
+    }
+    release_all(done);
+}
+
+void CZeroCopy::collect(std::vector<std::vector<uint8_t>> &out) {
+    for (auto it = _held.begin(); it != _held.end();) {
+        if (it->sealed && it->completed >= it->sends) {
+            out.push_back(std::move(it->buf));
+            it = _held.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CZeroCopy::release_all(std::vector<std::vector<uint8_t>> &bufs) {
+    if (bufs.empty()) return;
+    release_callback cb;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        cb = _on_release;
+    }
+    if (!cb) return;
+    for (auto &buf : bufs) cb(std::move(buf));
+}
+
+static size_t page_size() {
+#ifdef WIN32
+    return 4096;
+#else
+    static const size_t size = (size_t) sysconf(_SC_PAGESIZE);
+    return size;
+#endif
+}
+
+size_t CZeroCopy::frags(const void *data, size_t len) {
+    if (!len) return 0;
+    auto start = (uintptr_t) data;
+    return (start + len - 1) / page_size() - start / page_size() + 1;
+}
+
+size_t CZeroCopy::max_frags(size_t len) {
+    return len ? (len - 1) / page_size() + 2 : 0;
+}
+
+bool CZeroCopy::is_enabled() const {
+    return _enabled;
+}
+
+size_t CZeroCopy::get_held() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _held.size();
+}
+
+uint64_t CZeroCopy::get_completed() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _completed;
+}
+
+uint64_t CZeroCopy::get_copied() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _copied;
+}
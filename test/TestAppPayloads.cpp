@@ -0,0 +1,133 @@
+/**
+ * TestAppPayloads.cpp - Checks that app payloads starting with reserved type ids reach the app untouched
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <iostream>
+#include <mutex>
+#include <cstdlib>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+
+#define TEST_PORT "52101"
+#define TEST_TIMEOUT 3000
+
+std::mutex lock;
+std::vector<std::vector<uint8_t>> server_rx, client_rx;
+sockaddr_in client_addr{};
+
+void do_listen_server(CUDPServer *s) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) {
+        if (!s->do_rx(rx_buf, src, rx_bytes)) continue;
+        std::lock_guard<std::mutex> guard(lock);
+        client_addr = src;
+        server_rx.push_back(rx_buf);
+    }
+}
+
+void do_listen_client(CUDPClient *c) {
+    std::vector<uint8_t> rx_buf;
+    long rx_bytes;
+    while (true) {
+        if (!c->do_rx(rx_buf, rx_bytes)) continue;
+        std::lock_guard<std::mutex> guard(lock);
+        client_rx.push_back(rx_buf);
+    }
+}
+
+// wait until a list holds n payloads, keeping the client's timers running
+bool wait_for(CUDPClient &c, const std::vector<std::vector<uint8_t>> &rx, size_t n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TEST_TIMEOUT);
+    while (std::chrono::steady_clock::now() < deadline) {
+        c.service();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (rx.size() >= n) return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+int main() {
+    // EOT, handshake ENQ, reliable DATA and an RPC reply, each would have been eaten as a library frame
+    const std::vector<std::vector<uint8_t>> payloads = {
+            {FRAME_EOT, 'x'},
+            {FRAME_ENQ, NET_CAP_DELTA | NET_CAP_LZ | NET_CAP_CRC},
+            {RC_TYPE_DATA, 0, 0, 0, 0, 'y'},
+            {FRAME_ACK, 0},
+            {RPC_TYPE_REPLY, 1, 0, 0, 0},
+    };
+    int failed = 0;
+
+    CUDPServer s;
+    s.enable_checksum();
+    s.enable_reliable();
+    s.setup(TEST_PORT);
+    std::thread(do_listen_server, &s).detach();
+
+    CUDPClient c;
+    c.enable_checksum();
+    c.enable_reliable();
+    c.setup("127.0.0.1", TEST_PORT);
+    std::thread(do_listen_client, &c).detach();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TEST_TIMEOUT);
+    while (c.get_state() != CUDPClient::CONN_CONNECTED && std::chrono::steady_clock::now() < deadline) {
+        c.service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (c.get_state() != CUDPClient::CONN_CONNECTED) {
+        std::cerr << "Client never connected" << std::endl;
+        std::_Exit(1);
+    }
+
+    // client to server, plain sends and a raw chunk
+    for (const auto &p : payloads) c.do_tx(p);
+    c.do_tx_chunks(payloads[0], payloads[0].size());
+    if (!wait_for(c, server_rx, payloads.size() + 1)) {
+        std::cerr << "Server got " << server_rx.size() << " of " << payloads.size() + 1 << " payloads" << std::endl;
+        failed++;
+    }
+
+    // server to client, over a session the payloads above must not have closed or renegotiated
+    sockaddr_in dst;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        dst = client_addr;
+    }
+    for (const auto &p : payloads) s.do_tx(p, dst);
+    if (!wait_for(c, client_rx, payloads.size())) {
+        std::cerr << "Client got " << client_rx.size() << " of " << payloads.size() << " payloads" << std::endl;
+        failed++;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < server_rx.size() && i < payloads.size(); i++) {
+        if (server_rx[i] != payloads[i]) {
+            std::cerr << "Server payload " << i << " changed" << std::endl;
+            failed++;
+        }
+    }
+    for (size_t i = 0; i < client_rx.size() && i < payloads.size(); i++) {
+        if (client_rx[i] != payloads[i]) {
+            std::cerr << "Client payload " << i << " changed" << std::endl;
+            failed++;
+        }
+    }
+    if (!c.get_checksum()) {
+        std::cerr << "Checksums were renegotiated away" << std::endl;
+        failed++;
+    }
+
+    std::cout << (failed ? "FAIL" : "PASS") << std::endl;
+    std::cout.flush();
+
+    // rx threads are still blocked in their sockets
+    std::_Exit(failed ? 1 : 0);
+}
@@ -0,0 +1,108 @@
+/**
+ * TestSessionExpiry.cpp - Checks that the reliable channel keeps delivering after the server drops a session
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <iostream>
+#include <mutex>
+#include <cstdlib>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+
+#define TEST_PORT "52102"
+#define TEST_TIMEOUT 3000
+
+sockaddr_in client_addr{};
+std::mutex lock;
+
+void do_listen_server(CUDPServer *s) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) {
+        if (!s->do_rx(rx_buf, src, rx_bytes)) continue;
+        std::lock_guard<std::mutex> guard(lock);
+        client_addr = src;
+    }
+}
+
+void do_service_server(CUDPServer *s) {
+    while (true) {
+        s->service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void do_listen_client(CUDPClient *c) {
+    std::vector<uint8_t> rx_buf;
+    long rx_bytes;
+    while (true) c->do_rx(rx_buf, rx_bytes);
+}
+
+// send one reliable message each way and wait for both to arrive
+bool round_trip(CUDPServer &s, CUDPClient &c, uint8_t tag) {
+    std::vector<uint8_t> up = {'u', tag}, down = {'d', tag}, rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    bool got_up = false, got_down = false;
+
+    c.do_tx_reliable(up);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TEST_TIMEOUT);
+    while (!got_up && std::chrono::steady_clock::now() < deadline) {
+        c.service();
+        got_up = s.do_rx_reliable(rx_buf, src, rx_bytes) && rx_buf == up;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (!got_up) {
+        std::cerr << "Server never got reliable message " << (int) tag << std::endl;
+        return false;
+    }
+
+    s.do_tx_reliable(down, src);
+    while (!got_down && std::chrono::steady_clock::now() < deadline) {
+        c.service();
+        got_down = c.do_rx_reliable(rx_buf, rx_bytes) && rx_buf == down;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (!got_down) {
+        std::cerr << "Client never got reliable message " << (int) tag << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int failed = 0;
+
+    CUDPServer s;
+    s.enable_reliable();
+    s.setup(TEST_PORT);
+    std::thread(do_listen_server, &s).detach();
+    std::thread(do_service_server, &s).detach();
+
+    CUDPClient c;
+    c.enable_reliable();
+    c.setup("127.0.0.1", TEST_PORT);
+    std::thread(do_listen_client, &c).detach();
+
+    // both channels are past seq 0 before the session goes away
+    for (uint8_t tag = 0; tag < 3; tag++) {
+        if (!round_trip(s, c, tag)) failed++;
+    }
+
+    // no service() means no heartbeats, so the client is silent and the server drops its session
+    std::this_thread::sleep_for(std::chrono::milliseconds(SESSION_TIMEOUT + 500));
+
+    // the server's new channel starts over, the client's must follow it both ways
+    for (uint8_t tag = 3; tag < 6; tag++) {
+        if (!round_trip(s, c, tag)) failed++;
+    }
+
+    std::cout << (failed ? "FAIL" : "PASS") << std::endl;
+    std::cout.flush();
+
+    // rx threads are still blocked in their sockets
+    std::_Exit(failed ? 1 : 0);
+}
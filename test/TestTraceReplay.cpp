@@ -0,0 +1,101 @@
+/**
+ * TestTraceReplay.cpp - Send the datagrams of a recorded trace to a server
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <iostream>
+#include <csignal>
+#include <map>
+
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "../include/CTrace.hpp"
+
+volatile sig_atomic_t stop;
+
+void catch_signal(int sig) {
+    stop = 1;
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: replay <trace file> <server host> <server port> [speed] [rx|tx]" << std::endl;
+        std::cerr << "speed 1 keeps the recorded timing, 2 is twice as fast, 0 sends as fast as possible" << std::endl;
+        std::cerr << "rx (default) replays what a server received, tx what a client sent" << std::endl;
+        return 1;
+    }
+    double speed = argc > 4 ? std::stod(argv[4]) : 1;
+    uint8_t dir = argc > 5 && std::string(argv[5]) == "tx" ? CTrace::TRACE_TX : CTrace::TRACE_RX;
+
+    CTraceReader reader;
+    if (!reader.open(argv[1])) return 1;
+
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(std::stoi(argv[3]));
+    server.sin_addr.s_addr = inet_addr(argv[2]);
+
+    signal(SIGINT, catch_signal);
+
+    // one socket per recorded peer so the server sees as many clients as were recorded
+    std::map<uint64_t, int> sockets;
+    uint64_t sent = 0;
+    uint64_t bytes = 0;
+    uint64_t replies = 0;
+    int64_t max_lag_ns = 0;
+    int64_t first_ns = -1;
+    int64_t start_ns = now_ns();
+    std::vector<uint8_t> reply(65536);
+
+    trace_record rec{};
+    const uint8_t *data;
+    while (stop != 1 && reader.next(rec, data)) {
+        if (rec.dir != dir) continue;
+        uint64_t peer = ((uint64_t) rec.addr << 16) | rec.port;
+        auto it = sockets.find(peer);
+        if (it == sockets.end()) {
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            if (fd < 0) {
+                spdlog::error("Error opening socket");
+                break;
+            }
+            it = sockets.emplace(peer, fd).first;
+        }
+
+        // keep the recorded spacing, scaled
+        if (first_ns < 0) first_ns = rec.time_ns;
+        if (speed > 0) {
+            auto due = start_ns + (int64_t) ((double) (rec.time_ns - first_ns) / speed);
+            int64_t now = now_ns();
+            if (now < due) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+            else max_lag_ns = std::max(max_lag_ns, now - due);
+        }
+
+        if (sendto(it->second, data, rec.len, 0, (struct sockaddr *) &server, sizeof(server)) < 0) {
+            spdlog::warn("Error sending datagram");
+            continue;
+        }
+        sent++;
+        bytes += rec.len;
+
+        // don't let replies pile up in the socket buffer
+        while (recv(it->second, reply.data(), reply.size(), MSG_DONTWAIT) > 0) replies++;
+    }
+
+    double secs = (double) (now_ns() - start_ns) / 1e9;
+    spdlog::info("Sent " + std::to_string(sent) + " datagrams (" + std::to_string(bytes) + " bytes) from " +
+                 std::to_string(sockets.size()) + " peers in " + std::to_string(secs) + " s, " +
+                 std::to_string((uint64_t) ((double) sent / secs)) + " datagrams/s, " +
+                 std::to_string((double) bytes * 8 / secs / 1e6) + " Mbit/s");
+    if (speed > 0) spdlog::info("Fell behind the recorded timing by up to " + std::to_string((double) max_lag_ns / 1e6) + " ms");
+    spdlog::info(std::to_string(replies) + " replies received");
+
+    for (auto &s : sockets) close(s.second);
+    return 0;
+}
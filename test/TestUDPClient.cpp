@@ -11,11 +11,10 @@
 
 #include "../include/CUDPClient.hpp"
 
-#define PING_TIMEOUT 1000
 #define NET_DELAY 35
 
 volatile sig_atomic_t stop;
-volatile bool send_data = true;
+volatile bool send_data = false;
 volatile bool stop_main = false;
 
 void catch_signal(int sig) {
@@ -45,6 +44,8 @@ void do_send(CUDPClient *c, std::queue<std::string> *q) {
             std::vector<uint8_t> tx_buf(q->front().begin(),q->front().end());
             c->do_tx(tx_buf);
         }
+        // drive handshake retries and heartbeats
+        c->service();
         std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(NET_DELAY));
     }
 }
@@ -56,16 +57,17 @@ int main(int argc, char *argv[]) {
     }
 
     std::queue<std::string> tx_queue, rx_queue;
-    std::chrono::steady_clock::time_point timeout_count;
-    int time_since_start;
 
     std::vector<int> _rtimes;
 
     signal(SIGINT, catch_signal);
     CUDPClient c = CUDPClient();
+    c.set_state_callback([](CUDPClient::conn_state, CUDPClient::conn_state to) {
+        send_data = (to == CUDPClient::CONN_CONNECTED);
+    });
+    c.enable_compression();
+    c.enable_checksum();
     c.setup(argv[1], argv[2]);
-    timeout_count = std::chrono::steady_clock::now();
-    send_data = c.get_socket_status();
     // start listen thread
     std::thread thread_for_listening(do_listen, &c, &rx_queue);
     thread_for_listening.detach();
@@ -80,22 +82,12 @@ int main(int argc, char *argv[]) {
 //            spdlog::info("New in RX queue with size: " + std::to_string(rx_queue.front().size()));
 //            spdlog::info("Content: " + std::string(rx_queue.front().begin(), rx_queue.front().end()));
 //            spdlog::info("Remaining in queue: " + std::to_string(rx_queue.size()));
-
-            // reset timeout
-            // placement of this may be a source of future bug
-            timeout_count = std::chrono::steady_clock::now();
         }
 
-        time_since_start = (int) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - timeout_count).count();
-        if (time_since_start > PING_TIMEOUT) {
-            spdlog::warn("Server is gone...");
-            send_data = false;
-            do {
-                c.setdn();
-                c.setup(argv[1], argv[2]);
-            } while (!c.get_socket_status());
-            send_data = c.get_socket_status();
-            timeout_count = std::chrono::steady_clock::now();
+        // client reconnects on its own, just hold off sending until it does
+        if (!send_data) {
+            std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(NET_DELAY));
+            continue;
         }
         // send current time as payload
 //        tx_queue.emplace(std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
@@ -0,0 +1,80 @@
+/**
+ * TestUDPProxy.cpp - Impairing proxy for testing clients and servers on loopback
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <iostream>
+#include <csignal>
+
+#include "../include/CUDPProxy.hpp"
+
+volatile sig_atomic_t stop;
+
+void catch_signal(int sig) {
+    stop = 1;
+}
+
+// key=value options, times in ms and rate in kbit/s
+bool parse_option(const std::string &opt, impairment_config &cfg) {
+    size_t eq = opt.find('=');
+    if (eq == std::string::npos) return false;
+    std::string key = opt.substr(0, eq);
+    std::string value = opt.substr(eq + 1);
+    if (key == "delay") cfg.delay_us = (int64_t) (std::stod(value) * 1000);
+    else if (key == "jitter") cfg.jitter_us = (int64_t) (std::stod(value) * 1000);
+    else if (key == "dist" && value == "uniform") cfg.dist = impairment_config::DELAY_UNIFORM;
+    else if (key == "dist" && value == "normal") cfg.dist = impairment_config::DELAY_NORMAL;
+    else if (key == "dist" && value == "pareto") cfg.dist = impairment_config::DELAY_PARETO;
+    else if (key == "loss") cfg.loss = std::stod(value);
+    else if (key == "burst_enter") cfg.burst_enter = std::stod(value);
+    else if (key == "burst_exit") cfg.burst_exit = std::stod(value);
+    else if (key == "burst_loss") cfg.burst_loss = std::stod(value);
+    else if (key == "reorder") cfg.reorder = std::stod(value);
+    else if (key == "reorder_delay") cfg.reorder_us = (int64_t) (std::stod(value) * 1000);
+    else if (key == "dup") cfg.duplicate = std::stod(value);
+    else if (key == "rate") cfg.rate_bps = (uint64_t) (std::stod(value) * 1000);
+    else if (key == "queue") cfg.queue_bytes = std::stoul(value);
+    else if (key == "seed") cfg.seed = std::stoull(value);
+    else return false;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: proxy <listen port> <server host> <server port> [option=value ...]" << std::endl;
+        std::cerr << "Options (both directions): delay jitter dist=uniform|normal|pareto loss burst_enter burst_exit" << std::endl;
+        std::cerr << "                           burst_loss reorder reorder_delay dup rate queue seed" << std::endl;
+        return 1;
+    }
+
+    impairment_config cfg;
+    for (int i = 4; i < argc; i++) {
+        if (!parse_option(argv[i], cfg)) {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // same impairment both ways, but not the same random decisions
+    impairment_config down = cfg;
+    down.seed = cfg.seed + 1;
+
+    signal(SIGINT, catch_signal);
+    CUDPProxy p(cfg, down);
+    if (!p.start(argv[1], argv[2], argv[3])) return 1;
+
+    while (stop != 1) {
+        std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(1000));
+        impairment_stats up_stats = p.get_up_stats();
+        impairment_stats down_stats = p.get_down_stats();
+        spdlog::info("up: " + std::to_string(up_stats.packets) + " in, " + std::to_string(up_stats.delivered) + " out, " +
+                     std::to_string(up_stats.lost) + " lost, " + std::to_string(up_stats.queue_dropped) + " queue drops | down: " +
+                     std::to_string(down_stats.packets) + " in, " + std::to_string(down_stats.delivered) + " out, " +
+                     std::to_string(down_stats.lost) + " lost, " + std::to_string(down_stats.queue_dropped) + " queue drops");
+    }
+
+    p.stop();
+    spdlog::info("Goodbye");
+    return 0;
+}
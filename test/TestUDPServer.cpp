@@ -42,6 +42,8 @@ void do_send(CUDPServer *s, std::queue<std::string> *q, sockaddr_in *dst) {
             std::vector<uint8_t> tx_buf(q->front().begin(),q->front().end());
             s->do_tx(tx_buf,*dst);
         }
+        // run session timers and reliable retransmits
+        s->service();
         std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(NET_DELAY));
     }
 }
@@ -54,6 +56,8 @@ int main() {
 
     signal(SIGINT, catch_signal);
     CUDPServer c = CUDPServer();
+    c.enable_compression();
+    c.enable_checksum();
     c.setup("46188");
 
     // start listen thread
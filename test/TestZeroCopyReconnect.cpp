@@ -0,0 +1,82 @@
+/**
+ * TestZeroCopyReconnect.cpp - Checks that zero-copy buffers come back across setdn() and setup()
+ * 2026-10-19
+ * vika <https://github.com/hi-im-vika>
+ */
+
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+
+#include "../include/CUDPServer.hpp"
+#include "../include/CUDPClient.hpp"
+
+#define TEST_PORT "52103"
+#define TEST_TIMEOUT 3000
+#define TEST_SIZE 32768
+
+std::atomic<int> released{0};
+
+void do_listen_server(CUDPServer *s) {
+    std::vector<uint8_t> rx_buf;
+    sockaddr_in src{};
+    long rx_bytes;
+    while (true) s->do_rx(rx_buf, src, rx_bytes);
+}
+
+// keep reaping until n buffers have come back
+bool wait_released(CUDPClient &c, int n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TEST_TIMEOUT);
+    while (released < n && std::chrono::steady_clock::now() < deadline) {
+        c.service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return released >= n;
+}
+
+int main() {
+    int failed = 0;
+
+    CUDPServer s;
+    s.setup(TEST_PORT);
+    std::thread(do_listen_server, &s).detach();
+
+    CUDPClient c;
+    c.zerocopy().set_release_callback([](std::vector<uint8_t> &&) { released++; });
+    c.setup("127.0.0.1", TEST_PORT);
+    if (!c.enable_zerocopy()) {
+        std::cout << "SKIP, no zero-copy support" << std::endl;
+        std::cout.flush();
+        std::_Exit(0);
+    }
+
+    // one buffer sent before the reconnect, likely still lent out when setdn() runs
+    c.do_tx_zerocopy(std::vector<uint8_t>(TEST_SIZE, 'a'));
+    c.setdn();
+    if (released != 1 || c.zerocopy().get_held()) {
+        std::cerr << "setdn() kept " << c.zerocopy().get_held() << " buffers" << std::endl;
+        failed++;
+    }
+    if (c.zerocopy().is_enabled()) {
+        std::cerr << "Zero-copy still on after setdn()" << std::endl;
+        failed++;
+    }
+
+    // the new socket numbers its sends from 0, the buffers must still be matched to them
+    c.setup("127.0.0.1", TEST_PORT);
+    if (!c.enable_zerocopy()) {
+        std::cerr << "Zero-copy could not be turned back on" << std::endl;
+        failed++;
+    }
+    for (int i = 0; i < 3; i++) c.do_tx_zerocopy(std::vector<uint8_t>(TEST_SIZE, 'b'));
+    if (!wait_released(c, 4)) {
+        std::cerr << "Only " << released << " of 4 buffers came back after the reconnect" << std::endl;
+        failed++;
+    }
+
+    std::cout << (failed ? "FAIL" : "PASS") << std::endl;
+    std::cout.flush();
+
+    // rx thread is still blocked in its socket
+    std::_Exit(failed ? 1 : 0);
+}